@@ -0,0 +1,1047 @@
+#include "RigidBody.h"
+#include "CircleCollider.h"
+#include "RectangleCollider.h"
+#include "Physics.h"
+#include "ChunkedWorld.h"
+#include "DistributedWorld.h"
+#include "Integrator.h"
+#include "Narrowphase.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Differential fuzz harness: random scenes of circles and rotated rectangles
+// go through the brute-force reference (broadphase off, every pair in body
+// order) and through each optimized configuration. Every configuration
+// reports a correctness check and its speedup over the reference.
+//
+// Two kinds of checks, since the solver resolves pairs in the order they are
+// found and any reordering makes long runs diverge chaotically:
+//  - Collision detection from identical states. Every few steps the
+//    reference state is copied into a probe scene whose colliders are all
+//    sensors (detected, never resolved). The broadphase pair set and every
+//    touching pair's normal and depth must match the reference.
+//    The same probes check region, point and ray queries against a scan of
+//    every body.
+//  - Whole runs. Each configuration steps its own copy of the scene. Energy
+//    drift must stay within 5% (of the start energy) of the reference's, or
+//    within 4x what nudging every body by 1e-5 changes it if that is more.
+//    Nothing may go non-finite or leave the world, and modes that promise
+//    exact results (rollback replay and resimulation) must reproduce the run
+//    bit for bit. Resimulating only the bodies a change reaches (markDirty)
+//    must stay close to resimulating everything: within RESIM_TOLERANCE, or
+//    4x what moving every body by the snap distance changes, if that is more.
+//    A sparse scene of its own must keep that to a real subset of the bodies.
+//  - The periodic configuration has no reference (the brute-force path has
+//    no seams), so it is held to invariants: nothing breaks, and queries
+//    report every body exactly once, through ghosts at the seam included.
+//
+// The geometry and integrator templates also run in double and Fixed on
+// random shape pairs and must agree with float to within what each type can
+// resolve (a hit may only flip on a grazing contact).
+//
+// Chunk streaming (ChunkedWorld) unloads a chunk whose bodies are touching
+// with contact events and rollback on; nothing the physics keeps or reports
+// afterwards may point at the freed bodies.
+//
+// The multi-process mode (DistributedWorld) is checked separately: bodies
+// converge on the middle so the strips rebalance, and every run must give
+// back each body exactly once with the strips still ordered and at least two
+// halos wide.
+//
+// Usage: physics_fuzz [scenes] [steps] [seed]. Exits with 1 if any check fails.
+
+// ------------------ Tolerances ------------------
+const float NORMAL_TOLERANCE = 1e-5f;
+const float DEPTH_TOLERANCE = 1e-5f;
+const float QUERY_TOLERANCE = 1e-4f;   // Closest-hit distance against the scan
+const int QUERIES_PER_PROBE = 20;      // Of each kind: region, point, ray, all hits on a ray
+const float ENERGY_TOLERANCE = 0.05f;  // Floor for |drift - reference drift|, as a fraction of the start energy
+const float ESCAPE_MARGIN = 1.0f;      // How far outside the solid world a body may be found
+const int PROBE_INTERVAL = 10;         // Steps between detection checks
+const int REWIND_FRAMES = 20;
+const int PERTURBED_BODIES = 3;        // Bodies kicked before the markDirty resimulation
+const float RESIM_TOLERANCE = 1e-3f;   // Floor for position (m) and velocity (m/s) error against a full resimulation
+const float SNAP_DISTANCE = 1e-4f;     // How far off its old path the markDirty resimulation leaves a body
+const int SCALAR_CASES = 3000;         // Shape pairs run through every scalar type
+const int INTEGRATOR_STEPS = 120;
+const float DISTRIBUTED_HALO = 1.0f;   // Covers the largest fuzz body plus one step of travel
+const int DISTRIBUTED_RUNS = 4;        // Each run restarts from a fresh split
+
+// ------------------ Random scenes ------------------
+
+struct FuzzScene {
+    float width;
+    float height;
+    std::vector<std::unique_ptr<Collider>> colliders;
+    std::vector<std::unique_ptr<Collider>> sensors;  // Same shapes, as sensors, for the probe
+    std::vector<RigidBody> bodies;
+    std::vector<RigidBody> probeBodies;
+    int circles = 0;
+    int rects = 0;
+    int statics = 0;
+};
+
+static void generateScene(FuzzScene& scene, uint32_t seed) {
+    std::mt19937 rng(seed);
+    auto uniform = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+
+    scene.width = uniform(10.0f, 30.0f);
+    scene.height = uniform(8.0f, 20.0f);
+    int count = std::uniform_int_distribution<int>(50, 400)(rng);
+    int staticCount = std::uniform_int_distribution<int>(0, 6)(rng);
+    float circleShare = uniform(0.0f, 1.0f);
+
+    for (int i = 0; i < count + staticCount; i++) {
+        bool isStatic = i >= count;
+        float x = uniform(-scene.width / 2 + 0.5f, scene.width / 2 - 0.5f);
+        float y = uniform(-scene.height / 2 + 0.5f, scene.height / 2 - 0.5f);
+
+        float area;
+        if (isStatic) {
+            // Ledges and ramps, sometimes long enough to be a large proxy
+            float w = uniform(1.0f, 0.6f * scene.width);
+            float h = uniform(0.1f, 0.5f);
+            scene.colliders.emplace_back(new RectangleCollider(w, h));
+            scene.sensors.emplace_back(new RectangleCollider(w, h));
+            area = w * h;
+            scene.statics++;
+        } else if (uniform(0.0f, 1.0f) < circleShare) {
+            float r = uniform(0.05f, 0.5f);
+            scene.colliders.emplace_back(new CircleCollider(r));
+            scene.sensors.emplace_back(new CircleCollider(r));
+            area = 3.14159265f * r * r;
+            scene.circles++;
+        } else {
+            float w = uniform(0.1f, 1.0f);
+            float h = uniform(0.1f, 1.0f);
+            scene.colliders.emplace_back(new RectangleCollider(w, h));
+            scene.sensors.emplace_back(new RectangleCollider(w, h));
+            area = w * h;
+            scene.rects++;
+        }
+        scene.sensors.back()->setSensor(true);
+
+        RigidBody body(Vector2D(x, y), 1000.0f * area, isStatic);
+        body.setCollider(scene.colliders.back().get());
+        body.setAngle(uniform(0.0f, 6.2831853f));
+        body.setRestitution(uniform(0.0f, 0.8f));
+        body.setFriction(uniform(0.0f, 1.0f));
+        if (!isStatic) body.setVelocity(Vector2D(uniform(-3.0f, 3.0f), uniform(-3.0f, 3.0f)));
+        scene.bodies.push_back(body);
+    }
+
+    // Copies keep their ids, so probe pairs line up with the scene's
+    scene.probeBodies = scene.bodies;
+    for (size_t i = 0; i < scene.probeBodies.size(); i++) {
+        scene.probeBodies[i].setCollider(scene.sensors[i].get());
+    }
+}
+
+static std::vector<RigidBody*> pointersTo(std::vector<RigidBody>& bodies) {
+    std::vector<RigidBody*> pointers;
+    pointers.reserve(bodies.size());
+    for (RigidBody& body : bodies) pointers.push_back(&body);
+    return pointers;
+}
+
+// ------------------ Measurements ------------------
+
+// Kinetic plus potential energy, the latter measured from floor so it stays positive
+static double totalEnergy(const std::vector<RigidBody*>& bodies, const Vector2D& gravity, const Vector2D& floor) {
+    double energy = 0.0;
+    for (const RigidBody* body : bodies) {
+        if (body->isStaticBody()) continue;
+        Vector2D v = body->getVelocity();
+        energy += 0.5 * body->getMass() * v.dot(v) - body->getMass() * gravity.dot(body->getPosition() - floor);
+    }
+    return energy;
+}
+
+static uint64_t hashStates(const std::vector<RigidBody*>& bodies) {
+    uint64_t hash = 1469598103934665603ull;  // FNV-1a
+    for (const RigidBody* body : bodies) {
+        BodyState state = body->getState();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&state);
+        for (size_t i = 0; i < sizeof(state); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// Non-finite values or bodies outside the solid world
+static int countBroken(const std::vector<RigidBody*>& bodies, float width, float height) {
+    int broken = 0;
+    for (const RigidBody* body : bodies) {
+        BodyState s = body->getState();
+        bool finite = std::isfinite(s.position.x) && std::isfinite(s.position.y) &&
+                      std::isfinite(s.velocity.x) && std::isfinite(s.velocity.y) && std::isfinite(s.angle);
+        if (!finite || std::abs(s.position.x) > width / 2 + ESCAPE_MARGIN ||
+            std::abs(s.position.y) > height / 2 + ESCAPE_MARGIN) {
+            broken++;
+        }
+    }
+    return broken;
+}
+
+// What one collision pass found, keyed so it compares across Physics
+// instances (each world has its own boundary bodies, hence its own ids)
+struct DetectedContact {
+    Vector2D normal;
+    float depth;
+};
+
+struct Detection {
+    std::vector<uint64_t> pairs;  // Sorted
+    std::map<uint64_t, DetectedContact> contacts;
+};
+
+static uint32_t comparableId(const Physics& physics, uint32_t id) {
+    for (int side = 0; side < 4; side++) {
+        if (physics.getBoundaryBody(static_cast<BoundarySide>(side)).getId() == id) return 0xFFFFFF00u | side;
+    }
+    return id;
+}
+
+static void detect(Physics& physics, std::vector<RigidBody*>& probe, Detection& out) {
+    physics.checkBodyCollisions(probe);
+    out.pairs.clear();
+    out.contacts.clear();
+
+    for (const ContactPair& pair : physics.getContactCache().getSlots()) {
+        if (pair.key == 0) continue;
+        uint32_t a = comparableId(physics, pair.bodyA->getId());
+        uint32_t b = comparableId(physics, pair.bodyB->getId());
+        out.pairs.push_back(ContactCache::makeKey(std::min(a, b), std::max(a, b)));
+    }
+    std::sort(out.pairs.begin(), out.pairs.end());
+
+    for (const ContactEvent& event : physics.getContactEvents()) {
+        if (event.type == ContactEventType::End) continue;
+        uint32_t a = comparableId(physics, event.bodyA->getId());
+        uint32_t b = comparableId(physics, event.bodyB->getId());
+        // Normals point from the lower comparable id to the higher one
+        Vector2D normal = a < b ? event.normal : event.normal * -1.0f;
+        out.contacts[ContactCache::makeKey(std::min(a, b), std::max(a, b))] = DetectedContact{normal, event.depth};
+    }
+}
+
+// ------------------ Configurations ------------------
+
+struct Config {
+    const char* name;
+    bool broadphase;
+    float cellSize;   // 0 = the grid picks one
+    bool rollback;    // Record history, then check rewind + replay/resimulate
+    bool periodic;    // Left and right edges wrap; invariants only
+};
+
+static const Config CONFIGS[] = {
+    {"brute force", false, 0.0f, false, false},  // Reference
+    {"grid", true, 0.0f, false, false},
+    {"grid cell 0.25", true, 0.25f, false, false},
+    {"grid cell 2", true, 2.0f, false, false},
+    {"grid + rollback", true, 0.0f, true, false},
+    {"grid periodic", true, 0.0f, false, true},
+};
+const int CONFIG_COUNT = sizeof(CONFIGS) / sizeof(CONFIGS[0]);
+
+static void configure(Physics& physics, const Config& config) {
+    physics.setBroadphaseEnabled(config.broadphase);
+    physics.getBroadphase().setCellSize(config.cellSize);
+    if (config.periodic) physics.setBoundary(BoundarySide::Left, BoundaryMode::Periodic);
+}
+
+// Totals for one configuration over every scene
+struct Report {
+    long pairsChecked = 0;
+    long pairMismatches = 0;
+    long contactsChecked = 0;
+    long contactMismatches = 0;
+    float maxNormalError = 0.0f;
+    float maxDepthError = 0.0f;
+    long queriesChecked = 0;
+    long queryMismatches = 0;
+    double worstDriftError = 0.0;  // |drift - reference drift| over its tolerance; above 1 fails
+    long brokenBodies = 0;
+    int exactFailures = 0;
+    long dirtyBodies = 0;        // Bodies the markDirty resimulations stepped...
+    long resimBodies = 0;        // ...out of this many
+    float worstResimError = 0.0f;  // |subset - full| over its tolerance; above 1 fails
+    double stepMs = 0.0;
+    int failedScenes = 0;
+};
+
+static bool compareDetection(const Detection& ref, const Detection& got, Report& report) {
+    long before = report.pairMismatches + report.contactMismatches;
+
+    // Symmetric difference of the sorted pair sets
+    std::vector<uint64_t> diff;
+    std::set_symmetric_difference(ref.pairs.begin(), ref.pairs.end(), got.pairs.begin(), got.pairs.end(),
+                                  std::back_inserter(diff));
+    report.pairsChecked += static_cast<long>(ref.pairs.size());
+    report.pairMismatches += static_cast<long>(diff.size());
+
+    report.contactsChecked += static_cast<long>(ref.contacts.size());
+    for (const auto& entry : ref.contacts) {
+        auto it = got.contacts.find(entry.first);
+        if (it == got.contacts.end()) {
+            report.contactMismatches++;
+            continue;
+        }
+        float normalError = (it->second.normal - entry.second.normal).length();
+        float depthError = std::abs(it->second.depth - entry.second.depth);
+        report.maxNormalError = std::max(report.maxNormalError, normalError);
+        report.maxDepthError = std::max(report.maxDepthError, depthError);
+        if (normalError > NORMAL_TOLERANCE || depthError > DEPTH_TOLERANCE) report.contactMismatches++;
+    }
+    for (const auto& entry : got.contacts) {
+        if (!ref.contacts.count(entry.first)) report.contactMismatches++;
+    }
+    return report.pairMismatches + report.contactMismatches == before;
+}
+
+// Largest position or velocity difference between two runs of the same bodies
+static float stateError(const std::vector<BodyState>& a, const std::vector<BodyState>& b) {
+    float error = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        error = std::max(error, (a[i].position - b[i].position).length());
+        error = std::max(error, (a[i].velocity - b[i].velocity).length());
+    }
+    return error;
+}
+
+// Rewinds and steps forward again. Replaying the recorded timeline and
+// resimulating every body must land on the same state bit for bit.
+//
+// Then a few bodies get a kick after the rewind, and resimulating only what
+// markDirty reaches is compared with resimulating everything. The subset run
+// snaps bodies that drift less than SNAP_DISTANCE back onto their old paths,
+// which a pile can amplify, so the tolerance is the larger of RESIM_TOLERANCE
+// and 4x what nudging every body by SNAP_DISTANCE changes a full resimulation.
+//
+// Finally the unkicked run is restored, so the caller can keep stepping.
+// With requireSubset, the markDirty resimulation must also have stepped
+// fewer bodies than there are, or it was just the full one again.
+static bool checkRollback(Physics& physics, std::vector<RigidBody*>& bodies, float dt, Report& report,
+                          bool requireSubset = false) {
+    unsigned end = physics.getFrame();
+    uint64_t expected = hashStates(bodies);
+    if (end < static_cast<unsigned>(REWIND_FRAMES)) return true;
+    unsigned start = end - REWIND_FRAMES;
+
+    if (!physics.rewind(start)) return false;
+    physics.resimulate(bodies, end, dt);
+    if (hashStates(bodies) != expected) return false;
+
+    if (!physics.rewind(start)) return false;
+    physics.markAllDirty();
+    physics.resimulate(bodies, end, dt);
+    if (hashStates(bodies) != expected) return false;
+
+    // The same absolute kick every time, spread over the body list
+    std::vector<RigidBody*> kicked;
+    std::vector<Vector2D> kicks;
+    if (!physics.rewind(start)) return false;
+    for (int k = 0; k < PERTURBED_BODIES; k++) {
+        RigidBody* body = bodies[bodies.size() * k / PERTURBED_BODIES];
+        if (body->isStaticBody()) continue;
+        kicked.push_back(body);
+        kicks.push_back(body->getVelocity() + Vector2D(0.5f, 0.5f));
+    }
+
+    // Resimulates the kicked timeline from the rewind, optionally nudging every body first
+    std::mt19937 nudgeRng(end);
+    std::uniform_real_distribution<float> nudge(-SNAP_DISTANCE, SNAP_DISTANCE);
+    auto resimulateKicked = [&](bool subset, bool nudged, std::vector<BodyState>& out) {
+        if (nudged) {
+            for (RigidBody* body : bodies) {
+                if (!body->isStaticBody()) body->setPosition(body->getPosition() + Vector2D(nudge(nudgeRng), nudge(nudgeRng)));
+            }
+        }
+        for (size_t k = 0; k < kicked.size(); k++) {
+            kicked[k]->setVelocity(kicks[k]);
+            if (subset) physics.markDirty(kicked[k]);
+        }
+        if (!subset) physics.markAllDirty();
+        physics.resimulate(bodies, end, dt);
+        out.resize(bodies.size());
+        for (size_t i = 0; i < bodies.size(); i++) out[i] = bodies[i]->getState();
+    };
+
+    std::vector<BodyState> subset, full, nudged;
+    resimulateKicked(true, false, subset);
+    report.dirtyBodies += physics.getDirtyCount();
+    report.resimBodies += static_cast<long>(bodies.size());
+    bool subsetOk = !requireSubset || physics.getDirtyCount() < static_cast<int>(bodies.size());
+    if (!physics.rewind(start)) return false;
+    resimulateKicked(false, false, full);
+    if (!physics.rewind(start)) return false;
+    resimulateKicked(false, true, nudged);
+
+    float tolerance = std::max(RESIM_TOLERANCE, 4.0f * stateError(full, nudged));
+    float error = stateError(full, subset) / tolerance;
+    report.worstResimError = std::max(report.worstResimError, error);
+
+    if (!physics.rewind(start)) return false;
+    physics.markAllDirty();
+    physics.resimulate(bodies, end, dt);
+    return error <= 1.0f && subsetOk && hashStates(bodies) == expected;
+}
+
+// Widely spaced bodies drifting without gravity, so a kick reaches only its
+// neighbours and markDirty has a real subset to resimulate
+static void generateSparse(FuzzScene& scene, uint32_t seed) {
+    std::mt19937 rng(seed);
+    auto uniform = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+    scene.width = 40.0f;
+    scene.height = 30.0f;
+    for (int i = 0; i < 96; i++) {
+        Vector2D position(-scene.width / 2 + 3.0f * (i % 12 + 1) + uniform(-0.5f, 0.5f),
+                          -scene.height / 2 + 3.3f * (i / 12 + 1) + uniform(-0.5f, 0.5f));
+        float area;
+        if (i % 2 == 0) {
+            float r = uniform(0.1f, 0.3f);
+            scene.colliders.emplace_back(new CircleCollider(r));
+            area = 3.14159265f * r * r;
+            scene.circles++;
+        } else {
+            float w = uniform(0.2f, 0.6f);
+            float h = uniform(0.2f, 0.6f);
+            scene.colliders.emplace_back(new RectangleCollider(w, h));
+            area = w * h;
+            scene.rects++;
+        }
+        RigidBody body(position, 1000.0f * area, false);
+        body.setCollider(scene.colliders.back().get());
+        body.setAngle(uniform(0.0f, 6.2831853f));
+        body.setVelocity(Vector2D(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f)));
+        scene.bodies.push_back(body);
+    }
+}
+
+// Steps the sparse scene with rollback on, checking rewinds along the way
+static bool checkSparseRollback(uint32_t seed, float dt, Report& report) {
+    FuzzScene scene;
+    generateSparse(scene, seed);
+    Physics physics(scene.width, scene.height, Vector2D(0, 0));
+    physics.setRollbackEnabled(true, 2 * REWIND_FRAMES);
+    std::vector<RigidBody*> bodies = pointersTo(scene.bodies);
+
+    bool ok = true;
+    for (int check = 0; check < 3 && ok; check++) {
+        for (int step = 0; step < 2 * REWIND_FRAMES; step++) physics.step(bodies, dt);
+        ok = checkRollback(physics, bodies, dt, report, true);
+    }
+    std::printf("rollback, sparse scene: markDirty resimulation stepped %ld of %ld bodies, "
+                "worst error %.2f of tolerance: %s\n", report.dirtyBodies, report.resimBodies,
+                report.worstResimError, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// ------------------ Queries ------------------
+
+static bool sameBodies(std::vector<RigidBody*>& a, std::vector<RigidBody*>& b) {
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+// Grid queries against a scan of every body with the same per-body tests.
+// Closest hits are compared by distance, since two bodies can tie.
+static bool checkQueries(Physics& physics, std::vector<RigidBody*>& bodies, float width, float height,
+                         std::mt19937& rng, Report& report) {
+    auto uniform = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+    physics.updateBroadphase(bodies);
+    long before = report.queryMismatches;
+    std::vector<RigidBody*> got, expected;
+    std::vector<RaycastHit> hits;
+
+    for (int q = 0; q < QUERIES_PER_PROBE; q++) {
+        // Mostly small regions, now and then most of the world or hanging over an edge
+        Vector2D center(uniform(-width / 2, width / 2), uniform(-height / 2, height / 2));
+        float sx = uniform(0.0f, 1.0f), sy = uniform(0.0f, 1.0f);
+        Vector2D half(sx * sx * sx * width / 2, sy * sy * sy * height / 2);
+        AABB region{center - half, center + half};
+        physics.queryRegion(region, got);
+        expected.clear();
+        for (RigidBody* body : bodies) {
+            if (body->getCollider() && body->getAABB().overlaps(region)) expected.push_back(body);
+        }
+        if (!sameBodies(got, expected)) report.queryMismatches++;
+
+        physics.queryPoint(center, got);
+        expected.clear();
+        for (RigidBody* body : bodies) {
+            if (body->getCollider() && bodyContainsPoint(*body, center)) expected.push_back(body);
+        }
+        if (!sameBodies(got, expected)) report.queryMismatches++;
+
+        // Half the rays are endless. The direction is normalized the way Physics
+        // does it, so both sides cast exactly the same ray
+        float angle = uniform(0.0f, 6.2831853f);
+        Vector2D dir(std::cos(angle), std::sin(angle));
+        dir = dir / std::sqrt(dir.dot(dir));
+        float maxDistance = q % 2 ? std::numeric_limits<float>::infinity() : uniform(0.0f, width);
+        RaycastHit hit;
+        bool anyHit = physics.raycast(center, dir, maxDistance, hit);
+        physics.raycastAll(center, dir, maxDistance, hits);
+        got.clear();
+        for (const RaycastHit& h : hits) got.push_back(h.body);
+        expected.clear();
+        float closest = maxDistance;
+        for (RigidBody* body : bodies) {
+            float distance;
+            Vector2D normal;
+            if (!body->getCollider() || !raycastBody(*body, center, dir, maxDistance, distance, normal)) continue;
+            expected.push_back(body);
+            closest = std::min(closest, distance);
+        }
+        bool closestOk = anyHit == !expected.empty() && (!anyHit || std::abs(hit.distance - closest) <= QUERY_TOLERANCE);
+        if (!closestOk) report.queryMismatches++;
+        if (!sameBodies(got, expected)) report.queryMismatches++;
+        report.queriesChecked += 4;
+    }
+    return report.queryMismatches == before;
+}
+
+// A whole-world region finds every body once, and a point query at a body's
+// center finds it once. Bodies hanging over the low x edge are found again
+// through their ghost, one period along.
+static bool checkPeriodicQueries(Physics& physics, std::vector<RigidBody*>& bodies, float width, float height,
+                                 Report& report) {
+    physics.updateBroadphase(bodies);
+    long before = report.queryMismatches;
+    std::vector<RigidBody*> got, expected;
+
+    physics.queryRegion(AABB{Vector2D(-width, -height), Vector2D(width, height)}, got);
+    expected.clear();
+    for (RigidBody* body : bodies) {
+        if (body->getCollider()) expected.push_back(body);
+    }
+    if (!sameBodies(got, expected)) report.queryMismatches++;
+    report.queriesChecked++;
+
+    for (RigidBody* body : bodies) {
+        if (!body->getCollider()) continue;
+        Vector2D images[2] = {body->getPosition(), body->getPosition() + Vector2D(width, 0.0f)};
+        int imageCount = body->getAABB().min.x < -width / 2 ? 2 : 1;
+        for (int i = 0; i < imageCount; i++) {
+            physics.queryPoint(images[i], got);
+            if (std::count(got.begin(), got.end(), body) != 1) report.queryMismatches++;
+            report.queriesChecked++;
+        }
+    }
+    return report.queryMismatches == before;
+}
+
+// ------------------ Scalar types ------------------
+
+// One shape pair (kind 0: circles, 1: circle vs box, 2: boxes) and a plane
+// under shape A, in floats so every scalar type starts from the same values.
+// Circles use their w as the radius.
+struct ScalarCase {
+    int kind;
+    float ax, ay, aAngle, aw, ah;
+    float bx, by, bAngle, bw, bh;
+    float planeY, planeAngle;
+};
+
+struct ScalarResult {
+    bool hit;
+    float depth;
+    Vector2D normal;
+    bool planeHit;
+    float planeDepth;
+};
+
+// Runs the case through every Narrowphase test in scalar T, read back as float
+template <typename T>
+static void runGeometry(const ScalarCase& c, ScalarResult& out) {
+    using std::cos;
+    using std::sin;
+    Vector2<T> posA(T(c.ax), T(c.ay));
+    Vector2<T> posB(T(c.bx), T(c.by));
+    OrientedBox<T> boxA = makeOrientedBox(posA, T(c.aAngle), T(c.aw), T(c.ah));
+    OrientedBox<T> boxB = makeOrientedBox(posB, T(c.bAngle), T(c.bw), T(c.bh));
+
+    BasicContact<T> contact{};
+    Vector2<T> axis;
+    if (c.kind == 0) {
+        out.hit = circleVsCircle(posA, T(c.aw), posB, T(c.bw), contact, axis);
+    } else if (c.kind == 1) {
+        out.hit = circleVsBox(posA, T(c.aw), boxB, contact, axis);
+    } else {
+        out.hit = boxVsBox(boxA, boxB, contact, axis);
+    }
+    out.depth = static_cast<float>(contact.depth);
+    out.normal = Vector2D(contact.normal);
+
+    BasicContact<T> planeContact{};
+    Vector2<T> planePoint(T(0), T(c.planeY));
+    Vector2<T> n(cos(T(c.planeAngle)), sin(T(c.planeAngle)));
+    out.planeHit = c.kind == 2 ? planeVsBox(planePoint, n, boxA, planeContact)
+                               : planeVsCircle(planePoint, n, posA, T(c.aw), planeContact);
+    out.planeDepth = static_cast<float>(planeContact.depth);
+}
+
+// A thrown body through both integrator forms; they do the same math, so must land together
+template <typename T>
+static bool runIntegrator(Vector2D& landed) {
+    T dt = T(1.0f / 60.0f);
+    Vector2<T> gravity(T(0), T(-9.8f));
+    Vector2<T> position(T(1.5f), T(2.0f)), velocity(T(3.0f), T(4.0f)), acceleration;
+    T angle = T(0);
+    T px[1] = {position.x}, py[1] = {position.y}, vx[1] = {velocity.x}, vy[1] = {velocity.y};
+    for (int i = 0; i < INTEGRATOR_STEPS; i++) {
+        acceleration = gravity;
+        integrateSemiImplicit(position, velocity, acceleration, angle, T(1), dt);
+        integrateSemiImplicit(px, py, vx, vy, 1, gravity, dt);
+    }
+    landed = Vector2D(position);
+    return px[0] == position.x && py[0] == position.y;
+}
+
+// Compares scalar T against double. resolution is the smallest step T
+// represents near 1 m; depths get 64 of those, and normals also get 8 per
+// meter of separation they were divided by (or may switch to a nearly
+// parallel face of the other box when the two tie).
+template <typename T>
+static bool checkScalar(const char* name, float resolution, const std::vector<ScalarCase>& cases) {
+    const float depthTolerance = 64.0f * resolution;
+    float worstDepth = 0.0f, worstNormal = 0.0f;
+    int failures = 0;
+    for (const ScalarCase& c : cases) {
+        ScalarResult ref, got;
+        runGeometry<double>(c, ref);
+        runGeometry<T>(c, got);
+
+        bool ok = true;
+        if (got.hit != ref.hit) {
+            ok = (ref.hit ? ref.depth : got.depth) <= depthTolerance;
+        } else if (got.hit) {
+            float depthError = std::abs(got.depth - ref.depth);
+            float normalError = (got.normal - ref.normal).length();
+            float separation = c.kind == 0 ? c.aw + c.bw - ref.depth : c.aw - ref.depth;
+            float normalTolerance = depthTolerance + (c.kind == 2 ? 0.0f : 8.0f * resolution / separation);
+            if (c.kind == 2 && normalError > normalTolerance) {
+                const float angles[2] = {c.aAngle, c.bAngle};
+                for (float angle : angles) {
+                    Vector2D faces[2] = {Vector2D(std::cos(angle), std::sin(angle)),
+                                         Vector2D(-std::sin(angle), std::cos(angle))};
+                    for (const Vector2D& face : faces) {
+                        if (std::abs(std::abs(got.normal.dot(face)) - 1.0f) <= normalTolerance) normalError = 0.0f;
+                    }
+                }
+            }
+            worstDepth = std::max(worstDepth, depthError);
+            worstNormal = std::max(worstNormal, normalError);
+            ok = depthError <= depthTolerance && normalError <= normalTolerance;
+        }
+        if (got.planeHit != ref.planeHit) {
+            ok = ok && (ref.planeHit ? ref.planeDepth : got.planeDepth) <= depthTolerance;
+        } else if (got.planeHit) {
+            worstDepth = std::max(worstDepth, std::abs(got.planeDepth - ref.planeDepth));
+            ok = ok && std::abs(got.planeDepth - ref.planeDepth) <= depthTolerance;
+        }
+        if (!ok) failures++;
+    }
+
+    Vector2D refLanded, landed;
+    runIntegrator<double>(refLanded);
+    bool integratorOk = runIntegrator<T>(landed) &&
+                        (landed - refLanded).length() <= 16.0f * resolution * INTEGRATOR_STEPS;
+
+    bool ok = failures == 0 && integratorOk;
+    std::printf("scalar %s vs double: %d/%zu shape pairs off, worst |dd| %.2e, |dn| %.2e, integrator %s: %s\n",
+                name, failures, cases.size(), worstDepth, worstNormal, integratorOk ? "ok" : "off",
+                ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool checkScalarTypes(uint32_t seed) {
+    std::mt19937 rng(seed);
+    auto uniform = [&](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+    std::vector<ScalarCase> cases;
+    for (int i = 0; i < SCALAR_CASES; i++) {
+        ScalarCase c;
+        c.kind = i % 3;
+        c.ax = uniform(-1.0f, 1.0f);
+        c.ay = uniform(-1.0f, 1.0f);
+        c.aAngle = uniform(0.0f, 6.2831853f);
+        c.aw = uniform(0.1f, 1.0f);
+        c.ah = uniform(0.1f, 1.0f);
+        c.bx = uniform(-1.0f, 1.0f);
+        c.by = uniform(-1.0f, 1.0f);
+        c.bAngle = uniform(0.0f, 6.2831853f);
+        c.bw = uniform(0.1f, 1.0f);
+        c.bh = uniform(0.1f, 1.0f);
+        c.planeY = uniform(-1.0f, 1.0f);
+        c.planeAngle = uniform(0.0f, 6.2831853f);
+        cases.push_back(c);
+    }
+    bool floatOk = checkScalar<float>("float", 1e-6f, cases);
+    bool fixedOk = checkScalar<Fixed>("Fixed", 1.0f / Fixed::one, cases);
+    return floatOk && fixedOk;
+}
+
+// ------------------ Chunk streaming ------------------
+
+// Bodies owned by the loaded chunks around (0, 0), sorted
+static std::vector<const RigidBody*> liveChunkBodies(const ChunkedWorld& world) {
+    std::vector<const RigidBody*> live;
+    for (int32_t y = -3; y <= 3; y++) {
+        for (int32_t x = -3; x <= 3; x++) {
+            const WorldChunk* chunk = world.findChunk(x, y);
+            if (!chunk) continue;
+            for (const auto& body : chunk->bodies) live.push_back(body.get());
+        }
+    }
+    std::sort(live.begin(), live.end());
+    return live;
+}
+
+// Whether events, cached pairs and query results only name bodies the world still owns
+static bool onlyLiveBodies(ChunkedWorld& world) {
+    std::vector<const RigidBody*> live = liveChunkBodies(world);
+    auto isLive = [&](const RigidBody* body) { return std::binary_search(live.begin(), live.end(), body); };
+    Physics& physics = world.getPhysics();
+
+    for (const ContactEvent& event : physics.getContactEvents()) {
+        if (!isLive(event.bodyA) || !isLive(event.bodyB)) return false;
+    }
+    for (const ContactPair& pair : physics.getContactCache().getSlots()) {
+        if (pair.key != 0 && (!isLive(pair.bodyA) || !isLive(pair.bodyB))) return false;
+    }
+    std::vector<RigidBody*> found;
+    physics.queryRegion(AABB{Vector2D(-1e6f, -1e6f), Vector2D(1e6f, 1e6f)}, found);
+    for (const RigidBody* body : found) {
+        if (!isLive(body)) return false;
+    }
+    for (const RigidBody* body : world.getActiveBodies()) {
+        if (!isLive(body)) return false;
+    }
+    return true;
+}
+
+// Two circles resting against each other on a ledge in chunk (0, 0). The chunk
+// is unloaded by hand and then by moving the point of interest away, and each
+// time comes back with every body when the point returns.
+static bool checkChunkStreaming(float dt) {
+    const float chunkSize = 10.0f;
+    CircleCollider circle(0.5f);
+    RectangleCollider ledge(8.0f, 0.5f);
+    ChunkedWorld world(chunkSize);
+    world.getPhysics().setContactEventsEnabled(true);
+    world.getPhysics().setRollbackEnabled(true, 10);
+
+    RigidBody ledgeBody(Vector2D(), 1.0f, true);
+    ledgeBody.setCollider(&ledge);
+    RigidBody ball(Vector2D(), 1.0f);
+    ball.setCollider(&circle);
+    world.addBody(ledgeBody, Vector2d(5.0, 1.0));
+    world.addBody(ball, Vector2d(4.55, 1.75));
+    world.addBody(ball, Vector2d(5.45, 1.75));
+    const size_t bodyCount = 3;
+    int near = world.addPointOfInterest(Vector2d(5.0, 5.0));
+
+    auto settle = [&](int steps) {
+        bool touched = false;
+        for (int i = 0; i < steps; i++) {
+            world.step(dt);
+            touched = touched || !world.getPhysics().getContactEvents().empty();
+        }
+        return touched;
+    };
+    auto restored = [&]() {
+        const WorldChunk* chunk = world.findChunk(0, 0);
+        return chunk && chunk->bodies.size() == bodyCount;
+    };
+
+    bool touching = settle(30);
+
+    // By hand, between steps: the last step's events and history name these bodies
+    world.unloadChunk(0, 0);
+    Physics& physics = world.getPhysics();
+    bool handUnloadOk = onlyLiveBodies(world) && !physics.rewind(physics.getFrame() - 1);
+    settle(1);  // The point of interest is still near, so the chunk loads again
+    handUnloadOk = handUnloadOk && restored() && onlyLiveBodies(world);
+
+    // By the step itself, once the point of interest is far away
+    settle(30);
+    world.setPointOfInterest(near, Vector2d(1000.0, 5.0));
+    settle(1);
+    bool streamedOk = !world.findChunk(0, 0) && onlyLiveBodies(world);
+    world.setPointOfInterest(near, Vector2d(5.0, 5.0));
+    settle(1);
+    streamedOk = streamedOk && restored() && onlyLiveBodies(world);
+
+    bool ok = touching && handUnloadOk && streamedOk;
+    std::printf("chunk streaming with contact events: %s%s%s%s\n", ok ? "ok" : "FAILED",
+                touching ? "" : " (bodies never touched)", handUnloadOk ? "" : " (unloadChunk)",
+                streamedOk ? "" : " (streamed out)");
+    return ok;
+}
+
+// ------------------ Distributed ------------------
+
+// Most bodies in one narrow column, so the body-count quantiles that place
+// the initial boundaries land almost on top of each other
+static void generateColumn(FuzzScene& scene) {
+    scene.width = 20.0f;
+    scene.height = 20.0f;
+    scene.colliders.emplace_back(new CircleCollider(0.05f));
+    for (int i = 0; i < 240; i++) {
+        Vector2D position = i < 200 ? Vector2D(0.12f * (i % 2), -9.0f + 0.12f * (i / 2))
+                                    : Vector2D(-9.0f + 0.45f * (i - 200), 5.0f);
+        RigidBody body(position, 1.0f, false);
+        body.setCollider(scene.colliders.back().get());
+        scene.bodies.push_back(body);
+        scene.circles++;
+    }
+}
+
+// Steps the scene on 'processes' strips, rebalancing every few steps while the
+// bodies pile up in the middle, whose strips then shed width on both sides at once
+static bool checkDistributed(const FuzzScene& scene, int processes, int steps, float dt) {
+    DistributedWorld world(scene.width, scene.height);
+    world.setHaloWidth(DISTRIBUTED_HALO);
+    world.setBalanceInterval(5);
+    for (RigidBody body : scene.bodies) {
+        if (!body.isStaticBody()) {
+            float x = body.getPosition().x;
+            body.setVelocity(Vector2D(x < 0 ? 6.0f : -6.0f, body.getVelocity().y));
+        }
+        world.addBody(body);
+    }
+    int expected = world.getBodyCount();
+
+    bool ok = true;
+    for (int run = 0; run < DISTRIBUTED_RUNS && ok; run++) {
+        if (!world.run(processes, std::max(1, steps / DISTRIBUTED_RUNS), dt)) {
+            std::printf("  FAIL %d processes: run %d failed\n", processes, run);
+            return false;
+        }
+
+        // Every body back exactly once (getBodies is ordered by globalId)
+        const std::vector<DistributedBody>& bodies = world.getBodies();
+        int owned = 0;
+        for (const DomainInfo& domain : world.getDomains()) owned += domain.bodyCount;
+        bool conserved = world.getBodyCount() == expected && owned == expected;
+        for (int i = 0; i < world.getBodyCount() && conserved; i++) {
+            const BodyState& state = bodies[i].state;
+            conserved = bodies[i].globalId == static_cast<uint32_t>(i) &&
+                        std::isfinite(state.position.x) && std::isfinite(state.position.y);
+        }
+
+        // Strips tile the line in rank order, none thinner than two halos
+        const std::vector<DomainInfo>& domains = world.getDomains();
+        bool ordered = static_cast<int>(domains.size()) == processes &&
+                       std::isinf(domains.front().left) && std::isinf(domains.back().right);
+        for (int r = 0; r < static_cast<int>(domains.size()) && ordered; r++) {
+            ordered = domains[r].right - domains[r].left >= 2.0f * DISTRIBUTED_HALO - 1e-4f &&
+                      (r == 0 || domains[r].left == domains[r - 1].right);
+        }
+
+        if (!conserved || !ordered) {
+            std::printf("  FAIL %d processes, run %d:%s%s\n", processes, run,
+                        conserved ? "" : " bodies not conserved", ordered ? "" : " strips out of order");
+            for (const DomainInfo& domain : domains) {
+                std::printf("    [%g, %g) %d bodies\n", domain.left, domain.right, domain.bodyCount);
+            }
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// ------------------ Main ------------------
+int main(int argc, char** argv) {
+    int sceneCount = argc > 1 ? std::atoi(argv[1]) : 20;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 300;
+    uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+    if (argc > 4 || sceneCount <= 0 || steps <= 0) {
+        std::fprintf(stderr, "Usage: physics_fuzz [scenes] [steps] [seed]\n");
+        return 1;
+    }
+
+    const float dt = 1.0f / 60.0f;
+    const Vector2D gravity(0, -9.8f);
+    Report reports[CONFIG_COUNT];
+
+    for (int s = 0; s < sceneCount; s++) {
+        uint32_t sceneSeed = seed + static_cast<uint32_t>(s) * 7919u;
+        FuzzScene scene;
+        generateScene(scene, sceneSeed);
+
+        // Each configuration steps its own copy; the probes share one sensor copy
+        std::vector<std::unique_ptr<Physics>> worlds;
+        std::vector<std::unique_ptr<Physics>> probes;
+        std::vector<std::vector<RigidBody>> copies(CONFIG_COUNT, scene.bodies);
+        std::vector<std::vector<RigidBody*>> runs;
+        for (int c = 0; c < CONFIG_COUNT; c++) {
+            worlds.emplace_back(new Physics(scene.width, scene.height, gravity));
+            probes.emplace_back(new Physics(scene.width, scene.height, gravity));
+            configure(*worlds[c], CONFIGS[c]);
+            configure(*probes[c], CONFIGS[c]);
+            probes[c]->setContactEventsEnabled(true);
+            if (CONFIGS[c].rollback) worlds[c]->setRollbackEnabled(true, 2 * REWIND_FRAMES);
+            runs.push_back(pointersTo(copies[c]));
+        }
+        std::vector<RigidBody*> probe = pointersTo(scene.probeBodies);
+
+        // Chaos baseline: the reference with every body nudged by up to 1e-5
+        Physics nudgedWorld(scene.width, scene.height, gravity);
+        configure(nudgedWorld, CONFIGS[0]);
+        std::vector<RigidBody> nudged = scene.bodies;
+        std::mt19937 nudgeRng(sceneSeed);
+        std::uniform_real_distribution<float> nudge(-1e-5f, 1e-5f);
+        for (RigidBody& body : nudged) {
+            if (!body.isStaticBody()) body.setPosition(body.getPosition() + Vector2D(nudge(nudgeRng), nudge(nudgeRng)));
+        }
+        std::vector<RigidBody*> nudgedRun = pointersTo(nudged);
+
+        Vector2D floor(0, -scene.height / 2);
+        double startEnergy = totalEnergy(runs[0], gravity, floor);
+        std::vector<bool> detectionOk(CONFIG_COUNT, true);
+        std::vector<bool> rollbackOk(CONFIG_COUNT, true);
+        std::vector<bool> queriesOk(CONFIG_COUNT, true);
+        Detection refDetection, detection;
+        std::mt19937 queryRng(sceneSeed);
+
+        for (int step = 0; step < steps; step++) {
+            for (int c = 0; c < CONFIG_COUNT; c++) {
+                auto start = std::chrono::steady_clock::now();
+                worlds[c]->step(runs[c], dt);
+                reports[c].stepMs += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+            nudgedWorld.step(nudgedRun, dt);
+
+            // Rollback is checked again at the end, once the bodies have piled up
+            if (step + 1 == 2 * REWIND_FRAMES) {
+                for (int c = 0; c < CONFIG_COUNT; c++) {
+                    if (CONFIGS[c].rollback && !checkRollback(*worlds[c], runs[c], dt, reports[c])) rollbackOk[c] = false;
+                }
+            }
+
+            if (step % PROBE_INTERVAL != 0) continue;
+            // Every configuration detects from the reference's current state, then
+            // queries it; the periodic one checks queries on its own run instead
+            for (int c = 0; c < CONFIG_COUNT; c++) {
+                if (CONFIGS[c].periodic) {
+                    if (!checkPeriodicQueries(*worlds[c], runs[c], scene.width, scene.height, reports[c])) {
+                        queriesOk[c] = false;
+                    }
+                    continue;
+                }
+                for (size_t i = 0; i < probe.size(); i++) probe[i]->setState(runs[0][i]->getState());
+                detect(*probes[c], probe, c == 0 ? refDetection : detection);
+                if (c == 0) continue;
+                if (!compareDetection(refDetection, detection, reports[c])) detectionOk[c] = false;
+                if (!checkQueries(*probes[c], probe, scene.width, scene.height, queryRng, reports[c])) {
+                    queriesOk[c] = false;
+                }
+            }
+        }
+
+        // Drift as a fraction of the start energy
+        double scale = std::max(startEnergy, 1.0);
+        double refDrift = (totalEnergy(runs[0], gravity, floor) - startEnergy) / scale;
+        double chaos = std::abs((totalEnergy(nudgedRun, gravity, floor) - startEnergy) / scale - refDrift);
+        double driftTolerance = std::max<double>(ENERGY_TOLERANCE, 4.0 * chaos);
+
+        bool sceneOk = true;
+        for (int c = 0; c < CONFIG_COUNT; c++) {
+            Report& report = reports[c];
+            double drift = (totalEnergy(runs[c], gravity, floor) - startEnergy) / scale;
+            double driftError = CONFIGS[c].periodic ? 0.0 : std::abs(drift - refDrift) / driftTolerance;
+            int broken = countBroken(runs[c], scene.width, scene.height);
+            bool exact = rollbackOk[c] && (!CONFIGS[c].rollback || checkRollback(*worlds[c], runs[c], dt, report));
+
+            report.worstDriftError = std::max(report.worstDriftError, driftError);
+            report.brokenBodies += broken;
+            if (!exact) report.exactFailures++;
+            bool ok = detectionOk[c] && queriesOk[c] && driftError <= 1.0 && broken == 0 && exact;
+            if (!ok) {
+                report.failedScenes++;
+                sceneOk = false;
+                std::printf("  FAIL scene %d (seed %u) %s:%s%s%s%s%s\n", s, sceneSeed, CONFIGS[c].name,
+                            detectionOk[c] ? "" : " detection", queriesOk[c] ? "" : " queries",
+                            driftError <= 1.0 ? "" : " energy", broken == 0 ? "" : " broken bodies",
+                            exact ? "" : " rollback");
+            }
+        }
+        std::printf("scene %d (seed %u): %.1f x %.1f m, %d circles, %d rects, %d static, reference drift %+.4f %s\n",
+                    s, sceneSeed, scene.width, scene.height, scene.circles, scene.rects,
+                    scene.statics, refDrift, sceneOk ? "ok" : "FAILED");
+    }
+
+    bool allOk = checkScalarTypes(seed);
+    allOk = checkChunkStreaming(dt) && allOk;
+    Report sparseReport;
+    allOk = checkSparseRollback(seed, dt, sparseReport) && allOk;
+
+    // Multi-process mode on one random scene and one dense column; each run forks its own workers
+    FuzzScene distributedScene;
+    generateScene(distributedScene, seed);
+    for (int processes = 2; processes <= 4; processes++) {
+        bool ok = checkDistributed(distributedScene, processes, steps, dt);
+        std::printf("distributed, %d processes: %s\n", processes, ok ? "ok" : "FAILED");
+        allOk = allOk && ok;
+    }
+    FuzzScene columnScene;
+    generateColumn(columnScene);
+    for (int processes = 2; processes <= 4; processes++) {
+        bool ok = checkDistributed(columnScene, processes, steps, dt);
+        std::printf("distributed, dense column, %d processes: %s\n", processes, ok ? "ok" : "FAILED");
+        allOk = allOk && ok;
+    }
+
+    // ------------------ Summary ------------------
+    std::printf("\n%-18s %9s %9s %9s %10s %10s %7s %9s %8s %6s\n", "config", "pairs", "contacts", "queries",
+                "max |dn|", "max |dd|", "drift", "time ms", "speedup", "result");
+    for (int c = 0; c < CONFIG_COUNT; c++) {
+        const Report& r = reports[c];
+        double speedup = r.stepMs > 0.0 ? reports[0].stepMs / r.stepMs : 0.0;
+        if (c == 0) {
+            std::printf("%-18s %9s %9s %9s %10s %10s %7s %9.1f %7.2fx %6s\n", CONFIGS[c].name, "ref", "ref", "ref",
+                        "-", "-", "-", r.stepMs, 1.0, "ref");
+            continue;
+        }
+        allOk = allOk && r.failedScenes == 0;
+        char queries[32];
+        std::snprintf(queries, sizeof(queries), "%ld/%ld", r.queryMismatches, r.queriesChecked);
+        if (CONFIGS[c].periodic) {
+            std::printf("%-18s %9s %9s %9s %10s %10s %7s %9.1f %7.2fx %6s\n", CONFIGS[c].name, "-", "-", queries,
+                        "-", "-", "-", r.stepMs, speedup, r.failedScenes == 0 ? "ok" : "FAIL");
+            continue;
+        }
+        char pairs[32], contacts[32];
+        std::snprintf(pairs, sizeof(pairs), "%ld/%ld", r.pairMismatches, r.pairsChecked);
+        std::snprintf(contacts, sizeof(contacts), "%ld/%ld", r.contactMismatches, r.contactsChecked);
+        std::printf("%-18s %9s %9s %9s %10.2e %10.2e %7.2f %9.1f %7.2fx %6s\n", CONFIGS[c].name, pairs, contacts,
+                    queries, r.maxNormalError, r.maxDepthError, r.worstDriftError, r.stepMs, speedup,
+                    r.failedScenes == 0 ? "ok" : "FAIL");
+    }
+    std::printf("(pairs, contacts and queries: mismatches/checked; drift: worst error over its tolerance, "
+                "above 1 fails; the periodic world has no reference and is checked for invariants)\n");
+    for (int c = 0; c < CONFIG_COUNT; c++) {
+        const Report& r = reports[c];
+        if (!CONFIGS[c].rollback || r.resimBodies == 0) continue;
+        std::printf("%s: markDirty resimulation stepped %ld of %ld bodies (%.1f%%), worst error %.2f of tolerance\n",
+                    CONFIGS[c].name, r.dirtyBodies, r.resimBodies, 100.0 * r.dirtyBodies / r.resimBodies,
+                    r.worstResimError);
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+// Set on pool workers, and on a caller while it helps with its own job
+static thread_local bool insideJob = false;
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // The caller participates, so spawn one fewer worker
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::runChunks(std::unique_lock<std::mutex>& lock) {
+    const std::function<void(int, int)>* fn = job;
+    while (nextIndex < jobCount) {
+        int begin = nextIndex;
+        int end = std::min(jobCount, begin + jobGrain);
+        nextIndex = end;
+
+        lock.unlock();
+        (*fn)(begin, end);
+        lock.lock();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    insideJob = true;
+    unsigned seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+        if (stopping) return;
+        seenGeneration = generation;
+
+        activeWorkers++;
+        runChunks(lock);
+        activeWorkers--;
+        if (activeWorkers == 0) done.notify_all();
+    }
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+    if (count <= 0) return;
+    grain = std::max(1, grain);
+
+    // Not worth waking anyone for a single chunk. Nested calls run inline:
+    // the job slot is taken, and waiting for it from inside a job would deadlock.
+    if (workers.empty() || count <= grain || insideJob) {
+        fn(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    std::unique_lock<std::mutex> lock(mutex);
+    job = &fn;
+    jobCount = count;
+    jobGrain = grain;
+    nextIndex = 0;
+    generation++;
+    wake.notify_all();
+
+    insideJob = true;
+    runChunks(lock);
+    insideJob = false;
+    done.wait(lock, [&] { return activeWorkers == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,21 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include "Vector2D.h"
+
+// Axis-aligned bounding box in world space (meters)
+struct AABB {
+    Vector2D min;
+    Vector2D max;
+
+    bool overlaps(const AABB& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y;
+    }
+
+    bool contains(const Vector2D& p) const {
+        return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y;
+    }
+};
+
+#endif
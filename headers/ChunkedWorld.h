@@ -0,0 +1,113 @@
+#ifndef CHUNKEDWORLD_H
+#define CHUNKEDWORLD_H
+
+#include "Physics.h"
+#include "RigidBody.h"
+#include "Vector2D.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+enum class ChunkState {
+    Sleeping,  // Loaded but not simulated
+    Border,    // Simulated as static obstacles around the active region
+    Active     // Simulated normally
+};
+
+// Square region of the world. Owns the bodies whose centers are inside it.
+struct WorldChunk {
+    int32_t x;
+    int32_t y;
+    ChunkState state = ChunkState::Sleeping;
+    std::vector<std::unique_ptr<RigidBody>> bodies;
+};
+
+// Unbounded world split into square chunks around points of interest.
+//
+// World positions are doubles (Vector2d); loaded bodies keep float positions
+// relative to a floating origin that follows the first point of interest and
+// is rebased in whole chunks, so float precision never depends on how far from
+// (0, 0) the action is. Each step only touches chunks near a point of interest:
+//   - within activeRadius: simulated (contacts across chunk seams just work,
+//     since all active chunks share one Physics step)
+//   - one more chunk out: border, included as static so nothing falls into a
+//     frozen neighbour
+//   - within unloadRadius: sleeping in memory
+//   - beyond that: serialized to bytes (chunk-relative, so precision is kept)
+//     and reloaded on demand
+// Colliders stay owned by the caller; serialized bodies refer to them by the
+// index returned from registerCollider().
+class ChunkedWorld {
+    private:
+        float chunkSize;
+        double activeRadius;
+        double unloadRadius;
+        double rebaseDistance;
+        Vector2d origin;
+
+        Physics physics;
+        std::unordered_map<uint64_t, WorldChunk> chunks;
+        std::unordered_map<uint64_t, std::vector<uint8_t>> storedChunks;
+        std::vector<Vector2d> pointsOfInterest;
+        std::vector<Collider*> colliders;
+
+        // Scratch reused between steps
+        std::unordered_map<uint64_t, ChunkState> wanted;
+        std::vector<RigidBody*> activeBodies;
+        std::vector<RigidBody*> pinnedBodies;
+        std::vector<RigidBody*> stepList;
+        std::vector<RigidBody*> unloading;
+
+        static uint64_t chunkKey(int32_t x, int32_t y);
+        WorldChunk& chunkFor(int32_t x, int32_t y);
+        Vector2d chunkCorner(int32_t x, int32_t y) const;
+        void rebaseIfNeeded();
+        void updateChunkStates();
+        void migrateBodies();
+        int colliderIndex(Collider* collider) const;
+
+    public:
+        ChunkedWorld(float chunkSize, const Vector2D& gravity = Vector2D(0, -9.8f));
+
+        // Colliders must be registered (addBody does it) before chunks using them are serialized
+        int registerCollider(Collider* collider);
+        // Copies the prototype into the chunk containing worldPos; the world owns the copy.
+        // The pointer stays valid until its chunk is unloaded (reloading makes new bodies).
+        // Returns nullptr when the body went straight into a far, unloaded chunk's bytes.
+        RigidBody* addBody(const RigidBody& prototype, const Vector2d& worldPos);
+
+        int addPointOfInterest(const Vector2d& worldPos);
+        void setPointOfInterest(int index, const Vector2d& worldPos) { pointsOfInterest[index] = worldPos; }
+        void clearPointsOfInterest() { pointsOfInterest.clear(); }
+        void setRadii(double active, double unload);
+        void setRebaseDistance(double distance) { rebaseDistance = distance; }
+
+        void step(float dt);
+
+        // Floating origin: body positions are local, relative to getOrigin()
+        const Vector2d& getOrigin() const { return origin; }
+        Vector2d toWorld(const Vector2D& local) const;
+        Vector2D toLocal(const Vector2d& world) const;
+
+        // Chunk coordinates of a world position
+        int32_t chunkX(double worldX) const;
+        int32_t chunkY(double worldY) const;
+        float getChunkSize() const { return chunkSize; }
+        const WorldChunk* findChunk(int32_t x, int32_t y) const;
+        bool isChunkStored(int32_t x, int32_t y) const;
+        int getLoadedChunkCount() const { return static_cast<int>(chunks.size()); }
+        int getStoredChunkCount() const { return static_cast<int>(storedChunks.size()); }
+
+        // Manual streaming; the step does this automatically around points of interest.
+        // serializeChunk works on loaded and stored chunks.
+        bool serializeChunk(int32_t x, int32_t y, std::vector<uint8_t>& out) const;
+        bool loadChunk(int32_t x, int32_t y, const std::vector<uint8_t>& data);
+        bool unloadChunk(int32_t x, int32_t y);
+
+        // Bodies simulated by the last step (active chunks only)
+        const std::vector<RigidBody*>& getActiveBodies() const { return activeBodies; }
+        Physics& getPhysics() { return physics; }
+};
+
+#endif
@@ -1,21 +1,38 @@
 #pragma once
 #include "Vector2D.h"
+#include <cstdint>
 
 enum class ColliderType{
     Circle,
-    Rectangle
+    Rectangle,
+    Plane
 };
 
 class Collider {
     protected:
         ColliderType type;
+        uint16_t categoryBits = 0x0001;  // Which layers this collider belongs to
+        uint16_t maskBits = 0xFFFF;      // Which layers it collides with
+        bool sensor = false;             // Sensors report contacts but are never resolved
     public:
         Collider(ColliderType t) :type(t) {}
         virtual ~Collider() = default;
         
         ColliderType getType() const { return type;}
+        uint16_t getCategoryBits() const { return categoryBits; }
+        uint16_t getMaskBits() const { return maskBits; }
+        bool isSensor() const { return sensor; }
+        void setFilter(uint16_t category, uint16_t mask) { categoryBits = category; maskBits = mask; }
+        void setSensor(bool s) { sensor = s; }
+
+        // Two colliders interact only if each one's category is in the other's mask
+        static bool shouldCollide(uint16_t categoryA, uint16_t maskA, uint16_t categoryB, uint16_t maskB) {
+            return (categoryA & maskB) != 0 && (categoryB & maskA) != 0;
+        }
+
         virtual float getRadius() const { return 0.0f; }
         virtual float getWidth() const { return 0.0f; }
         virtual float getHeight() const { return 0.0f; }
+        virtual Vector2D getNormal() const { return Vector2D(); }
 
 };
\ No newline at end of file
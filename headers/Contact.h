@@ -0,0 +1,37 @@
+#ifndef CONTACT_H
+#define CONTACT_H
+
+#include "Vector2D.h"
+
+class RigidBody;
+
+// Narrowphase result for one touching pair
+template <typename T>
+struct BasicContact {
+    Vector2<T> normal;     // Unit normal pointing from body A towards body B
+    Vector2<T> point;      // Deepest world-space contact point
+    T depth;               // Penetration depth along the normal at point
+    Vector2<T> points[2];  // Full manifold (two points when faces touch)
+    int pointCount;
+};
+
+using Contact = BasicContact<float>;
+
+enum class ContactEventType {
+    Begin,    // First step the pair touches
+    Persist,  // Still touching since the previous step
+    End       // Touched last step, separated now (normal/point/depth are zero)
+};
+
+// Collected during a step and read afterwards with Physics::getContactEvents()
+struct ContactEvent {
+    ContactEventType type;
+    RigidBody* bodyA;
+    RigidBody* bodyB;
+    Vector2D normal;
+    Vector2D point;
+    float depth;
+    bool sensor;      // At least one of the colliders is a sensor
+};
+
+#endif
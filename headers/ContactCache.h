@@ -0,0 +1,97 @@
+#ifndef CONTACTCACHE_H
+#define CONTACTCACHE_H
+
+#include "Contact.h"
+#include "RigidBody.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Everything remembered about one broadphase pair between steps
+struct ContactPair {
+    uint64_t key;               // (lower body id << 32) | higher body id, 0 = empty slot
+    RigidBody* bodyA;           // Body with the lower id
+    RigidBody* bodyB;
+
+    // Manifold from the last step the pair touched. Normal points from A to B.
+    Vector2D normal;
+    Vector2D points[2];
+    float normalImpulse[2];     // Impulse applied at each point, kept for warm starting
+    int pointCount;
+
+    // Axis that separated the pair when it last did not touch (A to B)
+    Vector2D separatingAxis;
+    bool hasSeparatingAxis;
+
+    bool touching;
+    bool sensor;
+    unsigned firstFrame;        // Step the broadphase first reported the pair
+    unsigned lastSeenFrame;     // Last step the broadphase reported the pair
+    unsigned touchingFrames;    // Consecutive steps in contact
+};
+
+// Open-addressing hash table of ContactPairs keyed by body-id pair.
+// Pairs are added when the broadphase finds them and evicted once the
+// broadphase stops reporting them (their AABBs separated).
+class ContactCache {
+    private:
+        std::vector<ContactPair> slots;
+        size_t count = 0;
+        size_t mask = 0;
+
+        static size_t hashKey(uint64_t key);
+        void grow();
+        void eraseSlot(size_t slot);
+
+    public:
+        ContactCache();
+
+        static uint64_t makeKey(uint32_t idA, uint32_t idB);
+
+        // Returns the pair for (a, b), inserting a fresh one if needed.
+        // added is set when the pair was not cached yet. The returned pointer is
+        // valid until the next insertion.
+        ContactPair* findOrAdd(RigidBody* a, RigidBody* b, unsigned frame, bool& added);
+        ContactPair* find(uint32_t idA, uint32_t idB);
+        // Copies a saved pair in, replacing any pair with the same key
+        void insert(const ContactPair& pair);
+
+        // Removes every pair not seen this frame, calling onEvict(pair) first
+        template<class OnEvict>
+        void evictStale(unsigned frame, OnEvict&& onEvict);
+        // Removes every pair for which match(pair) returns true
+        template<class Match>
+        void removeIf(Match&& match);
+
+        void clear();
+        size_t size() const { return count; }
+
+        // Raw slot access for iteration and snapshots (empty slots have key 0)
+        const std::vector<ContactPair>& getSlots() const { return slots; }
+        void setSlots(const std::vector<ContactPair>& saved);
+};
+
+template<class OnEvict>
+void ContactCache::evictStale(unsigned frame, OnEvict&& onEvict) {
+    removeIf([&](const ContactPair& pair) {
+        if (pair.lastSeenFrame == frame) return false;
+        onEvict(pair);
+        return true;
+    });
+}
+
+template<class Match>
+void ContactCache::removeIf(Match&& match) {
+    size_t slot = 0;
+    while (slot < slots.size()) {
+        ContactPair& pair = slots[slot];
+        if (pair.key != 0 && match(pair)) {
+            eraseSlot(slot);
+            // eraseSlot may have shifted another pair into this slot; look again
+            continue;
+        }
+        slot++;
+    }
+}
+
+#endif
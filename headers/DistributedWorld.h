@@ -0,0 +1,83 @@
+#ifndef DISTRIBUTEDWORLD_H
+#define DISTRIBUTEDWORLD_H
+
+#include "Physics.h"
+#include "RigidBody.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Flat record of one dynamic body, as sent between domain processes
+struct DistributedBody {
+    uint32_t globalId;
+    BodyState state;
+    float mass;
+    float restitution;
+    float friction;
+    int32_t collider;  // Index from DistributedWorld::addCollider, -1 for none
+};
+
+// Final x-range and load of one domain
+struct DomainInfo {
+    float left;
+    float right;
+    int bodyCount;
+};
+
+// Optional multi-process mode: the world is cut into vertical strips, and each
+// strip is stepped by its own forked process with its own Physics.
+//
+// Neighbouring processes are linked by Unix domain sockets. After every step
+// they swap, in one message per link:
+//   - migrants: bodies whose center crossed the shared boundary
+//   - halo: bodies within haloWidth of the boundary, simulated on the other
+//     side as ghosts (dynamic, so a pair straddling the boundary gets the same
+//     mass-weighted response on both sides; ghost results are then discarded).
+//     A ghost keeps its local body id from step to step, so pairs straddling
+//     the boundary keep their cached contacts like any other pair.
+//   - the sender's body count, and every balanceInterval steps a proposed new
+//     boundary position from the more loaded side
+// Static bodies are copied into every process. Boundaries start at body-count
+// quantiles and then drift with density, e.g. towards a filling cup; no strip
+// is ever narrower than two halos.
+//
+// Workers are forked, so they must not rely on threads started by the parent
+// (ThreadPool::shared() included). Everything runs on one machine.
+class DistributedWorld {
+    private:
+        float worldWidth;
+        float worldHeight;
+        Vector2D gravity;
+        float haloWidth;
+        int balanceInterval;
+
+        std::vector<Collider*> colliders;
+        std::vector<RigidBody> staticBodies;
+        std::vector<DistributedBody> bodies;
+        std::vector<DomainInfo> domains;
+
+    public:
+        DistributedWorld(float width, float height, const Vector2D& grav = Vector2D(0, -9.8f));
+
+        int addCollider(Collider* collider);
+        // Static bodies go to every process; dynamic ones to the domain containing them
+        void addBody(const RigidBody& body);
+
+        // Must cover the largest body plus how far it can move in one step (default 0.5 m)
+        void setHaloWidth(float width) { haloWidth = width; }
+        // Steps between boundary moves; 0 keeps the initial split
+        void setBalanceInterval(int steps) { balanceInterval = steps; }
+
+        // Forks one process per domain, runs them in lockstep and collects the
+        // results. onStep (optional) runs inside each worker after every step
+        // with its rank and owned bodies. Returns false if any worker failed.
+        bool run(int processes, int steps, float dt,
+                 const std::function<void(int rank, int step, const std::vector<DistributedBody>& owned)>& onStep = nullptr);
+
+        // Dynamic bodies after run(), ordered by globalId (the order they were added)
+        const std::vector<DistributedBody>& getBodies() const { return bodies; }
+        const std::vector<DomainInfo>& getDomains() const { return domains; }
+        int getBodyCount() const { return static_cast<int>(bodies.size()); }
+};
+
+#endif
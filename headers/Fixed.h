@@ -0,0 +1,170 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <cstdint>
+#include <limits>
+
+// Q16.16 fixed-point number: 16 integer bits, 16 fraction bits (resolution
+// ~1.5e-5, values in [-32768, 32768)). Every operation is plain integer math,
+// so results are bit-identical on every platform and compiler, which is what
+// lockstep simulations need.
+//
+// Products and quotients go through 64 bits and saturate to that range
+// (division by zero gives max() or lowest() by sign), so a squared distance
+// is only exact for lengths under ~181. Use hypot() or Vector2::length(),
+// which take the square root of the 64-bit sum, for lengths at world scale.
+// Sums, differences and negation wrap modulo 2^32 (computed unsigned, so
+// overflow is defined); conversions from int, float and double saturate,
+// and NaN converts to 0.
+class Fixed {
+    public:
+        static constexpr int fractionBits = 16;
+        static constexpr int32_t one = 1 << fractionBits;
+
+        int32_t raw;
+
+        constexpr Fixed() : raw(0) {}
+        constexpr Fixed(int value) : raw(saturate(static_cast<int64_t>(value) * one)) {}
+        constexpr explicit Fixed(float value) : raw(round(static_cast<double>(value) * one)) {}
+        constexpr explicit Fixed(double value) : raw(round(value * one)) {}
+
+        static constexpr Fixed fromRaw(int32_t bits) {
+            Fixed f;
+            f.raw = bits;
+            return f;
+        }
+
+        constexpr explicit operator float() const { return static_cast<float>(raw) / one; }
+        constexpr explicit operator double() const { return static_cast<double>(raw) / one; }
+        constexpr explicit operator int() const { return raw >> fractionBits; }
+
+        constexpr Fixed operator-() const { return fromRaw(wrap(0u - static_cast<uint32_t>(raw))); }
+        constexpr Fixed operator+(Fixed o) const {
+            return fromRaw(wrap(static_cast<uint32_t>(raw) + static_cast<uint32_t>(o.raw)));
+        }
+        constexpr Fixed operator-(Fixed o) const {
+            return fromRaw(wrap(static_cast<uint32_t>(raw) - static_cast<uint32_t>(o.raw)));
+        }
+        constexpr Fixed operator*(Fixed o) const {
+            return fromRaw(saturate((static_cast<int64_t>(raw) * o.raw) >> fractionBits));
+        }
+        constexpr Fixed operator/(Fixed o) const {
+            if (o.raw == 0) return fromRaw(raw == 0 ? 0 : raw > 0 ? INT32_MAX : INT32_MIN);
+            return fromRaw(saturate((static_cast<int64_t>(raw) * one) / o.raw));
+        }
+        constexpr Fixed& operator+=(Fixed o) { return *this = *this + o; }
+        constexpr Fixed& operator-=(Fixed o) { return *this = *this - o; }
+        constexpr Fixed& operator*=(Fixed o) { return *this = *this * o; }
+        constexpr Fixed& operator/=(Fixed o) { return *this = *this / o; }
+
+        constexpr bool operator==(Fixed o) const { return raw == o.raw; }
+        constexpr bool operator!=(Fixed o) const { return raw != o.raw; }
+        constexpr bool operator<(Fixed o) const { return raw < o.raw; }
+        constexpr bool operator>(Fixed o) const { return raw > o.raw; }
+        constexpr bool operator<=(Fixed o) const { return raw <= o.raw; }
+        constexpr bool operator>=(Fixed o) const { return raw >= o.raw; }
+
+        // Found by argument-dependent lookup, so templates can call sqrt(x) etc.
+        // after `using std::sqrt;` and get the right version for any scalar
+        friend constexpr Fixed abs(Fixed a) { return a.raw < 0 ? -a : a; }
+        friend constexpr Fixed floor(Fixed a) { return fromRaw(a.raw & ~(one - 1)); }
+
+        friend constexpr Fixed sqrt(Fixed a) {
+            if (a.raw <= 0) return Fixed();
+            // Integer square root of raw << 16 gives the root in Q16.16
+            return fromRaw(saturate(static_cast<int64_t>(isqrt(static_cast<uint64_t>(a.raw) << fractionBits))));
+        }
+
+        // sqrt(a * a + b * b) without squaring in Q16.16: the raw squares are
+        // summed in 64 bits (Q32.32), whose integer root is already Q16.16
+        friend constexpr Fixed hypot(Fixed a, Fixed b) {
+            uint64_t sa = static_cast<uint64_t>(a.raw < 0 ? -static_cast<int64_t>(a.raw) : a.raw);
+            uint64_t sb = static_cast<uint64_t>(b.raw < 0 ? -static_cast<int64_t>(b.raw) : b.raw);
+            return fromRaw(saturate(static_cast<int64_t>(isqrt(sa * sa + sb * sb))));
+        }
+
+        friend constexpr Fixed sin(Fixed a) {
+            const Fixed pi = fromRaw(205887);       // 3.14159
+            const Fixed halfPi = fromRaw(102944);
+            const Fixed twoPi = fromRaw(411775);
+
+            // Reduce to [-pi, pi], then fold into [-pi/2, pi/2] where the series converges fast
+            Fixed x = fromRaw(a.raw % twoPi.raw);
+            if (x > pi) x -= twoPi;
+            if (x < -pi) x += twoPi;
+            if (x > halfPi) x = pi - x;
+            if (x < -halfPi) x = -pi - x;
+
+            // Taylor series in Horner form up to x^11
+            Fixed x2 = x * x;
+            Fixed r = Fixed(1) - x2 / Fixed(110);
+            r = Fixed(1) - x2 / Fixed(72) * r;
+            r = Fixed(1) - x2 / Fixed(42) * r;
+            r = Fixed(1) - x2 / Fixed(20) * r;
+            r = Fixed(1) - x2 / Fixed(6) * r;
+            return x * r;
+        }
+
+        friend constexpr Fixed cos(Fixed a) { return sin(a + fromRaw(102944)); }
+
+    private:
+        static constexpr int32_t saturate(int64_t v) {
+            return v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : static_cast<int32_t>(v);
+        }
+
+        // Two's-complement reading of a wrapped unsigned result, without an
+        // out-of-range conversion
+        static constexpr int32_t wrap(uint32_t v) {
+            return v <= static_cast<uint32_t>(INT32_MAX) ? static_cast<int32_t>(v)
+                                                         : static_cast<int32_t>(v - 0x80000000u) + INT32_MIN;
+        }
+
+        static constexpr uint64_t isqrt(uint64_t n) {
+            uint64_t result = 0;
+            uint64_t bit = uint64_t(1) << 62;
+            while (bit > n) bit >>= 2;
+            while (bit != 0) {
+                if (n >= result + bit) {
+                    n -= result + bit;
+                    result = (result >> 1) + bit;
+                } else {
+                    result >>= 1;
+                }
+                bit >>= 2;
+            }
+            return result;
+        }
+
+        static constexpr int32_t round(double v) {
+            if (!(v == v)) return 0;  // NaN
+            if (v >= static_cast<double>(INT32_MAX)) return INT32_MAX;
+            if (v <= static_cast<double>(INT32_MIN)) return INT32_MIN;
+            return static_cast<int32_t>(v < 0 ? v - 0.5 : v + 0.5);
+        }
+};
+
+namespace std {
+template <>
+class numeric_limits<Fixed> {
+    public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_exact = true;
+        static constexpr bool has_infinity = false;
+        static constexpr Fixed min() { return Fixed::fromRaw(1); }
+        static constexpr Fixed max() { return Fixed::fromRaw(std::numeric_limits<int32_t>::max()); }
+        static constexpr Fixed lowest() { return Fixed::fromRaw(std::numeric_limits<int32_t>::min()); }
+        static constexpr Fixed epsilon() { return Fixed::fromRaw(1); }
+};
+}
+
+static_assert(Fixed(200) * Fixed(200) == std::numeric_limits<Fixed>::max(), "Fixed products must saturate");
+static_assert(Fixed(-200) * Fixed(200) == std::numeric_limits<Fixed>::lowest(), "Fixed products must saturate");
+static_assert(Fixed(3) / Fixed() == std::numeric_limits<Fixed>::max(), "Fixed division by zero must saturate");
+static_assert(Fixed(30000) + Fixed(30000) == Fixed(-5536), "Fixed sums must wrap, not overflow");
+static_assert(-std::numeric_limits<Fixed>::lowest() == std::numeric_limits<Fixed>::lowest(), "Fixed negation must wrap");
+static_assert(Fixed(40000) == std::numeric_limits<Fixed>::max(), "Fixed conversions must saturate");
+static_assert(Fixed(-1e12) == std::numeric_limits<Fixed>::lowest(), "Fixed conversions must saturate");
+static_assert(hypot(Fixed(200), Fixed(0)) == Fixed(200), "hypot must not overflow at world scale");
+static_assert(hypot(Fixed(3000), Fixed(4000)) == Fixed(5000), "hypot must not overflow at world scale");
+
+#endif
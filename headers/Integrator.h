@@ -0,0 +1,31 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "Vector2D.h"
+
+// Semi-implicit Euler, the integrator behind RigidBody::update. Templated on
+// the scalar so the same step runs in float, double or Fixed.
+template <typename T>
+constexpr void integrateSemiImplicit(Vector2<T>& position, Vector2<T>& velocity, Vector2<T>& acceleration,
+                                     T& angle, T angularV, T dt) {
+    velocity += acceleration * dt;
+    position += velocity * dt;
+    angle += angularV * dt;
+    acceleration = Vector2<T>(T(0), T(0));
+}
+
+// Structure-of-arrays version for particle-style state. Plain index loops with
+// no aliasing between the arrays, so the compiler can vectorize them.
+template <typename T>
+constexpr void integrateSemiImplicit(T* __restrict posX, T* __restrict posY,
+                                     T* __restrict velX, T* __restrict velY,
+                                     int count, Vector2<T> acceleration, T dt) {
+    for (int i = 0; i < count; i++) {
+        velX[i] += acceleration.x * dt;
+        velY[i] += acceleration.y * dt;
+        posX[i] += velX[i] * dt;
+        posY[i] += velY[i] * dt;
+    }
+}
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include "Contact.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Shape-vs-shape contact generation on plain geometry, templated on the scalar
+// (float, double or Fixed). Physics feeds these from RigidBody/Collider.
+//
+// Each test fills contact on a hit. On a miss it fills separatingAxis (A to B)
+// when it found one, or leaves it alone.
+
+// Oriented box in world space
+template <typename T>
+struct OrientedBox {
+    Vector2<T> center;
+    Vector2<T> axisX;
+    Vector2<T> axisY;
+    T halfWidth;
+    T halfHeight;
+};
+
+template <typename T>
+OrientedBox<T> makeOrientedBox(const Vector2<T>& center, T angle, T width, T height) {
+    using std::cos;
+    using std::sin;
+    T c = cos(angle);
+    T s = sin(angle);
+    return OrientedBox<T>{center, Vector2<T>(c, s), Vector2<T>(-s, c), width / T(2), height / T(2)};
+}
+
+// Half the length of a box's shadow on an axis
+template <typename T>
+constexpr T boxExtent(const OrientedBox<T>& box, const Vector2<T>& axis) {
+    using std::abs;
+    return box.halfWidth * abs(axis.dot(box.axisX)) + box.halfHeight * abs(axis.dot(box.axisY));
+}
+
+// Circle vs circle. Normal points from A to B.
+template <typename T>
+bool circleVsCircle(const Vector2<T>& posA, T radiusA, const Vector2<T>& posB, T radiusB,
+                    BasicContact<T>& contact, Vector2<T>& separatingAxis) {
+    // Calculate distance between centers
+    Vector2<T> delta = posB - posA;
+    T distance = delta.length();
+    T minDistance = radiusA + radiusB;
+
+    // Check if circles are overlapping
+    if (distance < minDistance && distance > T(0.0001f)) {
+        contact.normal = delta / distance;
+        contact.depth = minDistance - distance;
+        contact.point = posA + contact.normal * radiusA;
+        contact.points[0] = contact.point;
+        contact.pointCount = 1;
+        return true;
+    }
+    if (distance > T(0.0001f)) separatingAxis = delta / distance;
+    return false;
+}
+
+// Circle vs oriented box. Normal points from the box to the circle.
+template <typename T>
+bool circleVsBox(const Vector2<T>& circlePos, T radius, const OrientedBox<T>& box,
+                 BasicContact<T>& contact, Vector2<T>& separatingAxis) {
+    using std::abs;
+    T c = box.axisX.x;
+    T s = box.axisX.y;
+
+    // Circle position in the box's local space
+    Vector2<T> delta = circlePos - box.center;
+    Vector2<T> localDelta(delta.x * c + delta.y * s, delta.x * -s + delta.y * c);
+
+    // Clamp the circle's center to the box in local space
+    T closestX = std::max(-box.halfWidth, std::min(box.halfWidth, localDelta.x));
+    T closestY = std::max(-box.halfHeight, std::min(box.halfHeight, localDelta.y));
+
+    // Rotate the closest point back to world space
+    Vector2<T> closestPoint(closestX * c - closestY * s + box.center.x,
+                            closestX * s + closestY * c + box.center.y);
+
+    // Calculate distance from circle center to closest point
+    Vector2<T> distVec = circlePos - closestPoint;
+    T distance = distVec.length();
+
+    if (distance >= radius) {
+        separatingAxis = distVec / distance;
+        return false;
+    }
+
+    // Calculate collision normal (from box to circle)
+    if (distance > T(0.0001f)) {
+        contact.normal = distVec / distance;
+    } else {
+        // Center is on or inside the box: use the face it is closest to (in local space)
+        Vector2<T> localNormal;
+        if (abs(localDelta.x) > abs(localDelta.y)) {
+            localNormal = Vector2<T>(localDelta.x > T(0) ? T(1) : T(-1), T(0));
+        } else {
+            localNormal = Vector2<T>(T(0), localDelta.y > T(0) ? T(1) : T(-1));
+        }
+        contact.normal = Vector2<T>(localNormal.x * c - localNormal.y * s,
+                                    localNormal.x * s + localNormal.y * c);
+    }
+    contact.depth = radius - distance;
+    contact.point = closestPoint;
+    contact.points[0] = closestPoint;
+    contact.pointCount = 1;
+    return true;
+}
+
+// Box vs box: separating axis test, then clip the incident face against the
+// reference face to get up to two contact points. Normal points from A to B.
+template <typename T>
+bool boxVsBox(const OrientedBox<T>& boxA, const OrientedBox<T>& boxB,
+              BasicContact<T>& contact, Vector2<T>& separatingAxis) {
+    using std::abs;
+    const OrientedBox<T>* boxes[2] = {&boxA, &boxB};
+    Vector2<T> delta = boxB.center - boxA.center;
+    const Vector2<T> axes[4] = {boxA.axisX, boxA.axisY, boxB.axisX, boxB.axisY};
+
+    // Find the axis of least penetration (largest separation)
+    T bestSeparation = std::numeric_limits<T>::lowest();
+    int bestAxis = 0;
+    for (int i = 0; i < 4; i++) {
+        T separation = abs(delta.dot(axes[i])) - boxExtent(boxA, axes[i]) - boxExtent(boxB, axes[i]);
+        if (separation > T(0)) {
+            separatingAxis = delta.dot(axes[i]) >= T(0) ? axes[i] : axes[i] * T(-1);
+            return false;
+        }
+        // Small bias towards A's faces keeps the reference face stable between steps
+        if (separation > bestSeparation + T(1e-4f)) {
+            bestSeparation = separation;
+            bestAxis = i;
+        }
+    }
+
+    // Reference box owns the chosen axis; its normal points towards the incident box
+    int ref = bestAxis < 2 ? 0 : 1;
+    const OrientedBox<T>& refBox = *boxes[ref];
+    const OrientedBox<T>& incBox = *boxes[1 - ref];
+    Vector2<T> refNormal = axes[bestAxis];
+    Vector2<T> toInc = incBox.center - refBox.center;
+    if (toInc.dot(refNormal) < T(0)) refNormal = refNormal * T(-1);
+
+    bool refAlongX = (bestAxis % 2) == 0;
+    Vector2<T> faceCenter = refBox.center + refNormal * (refAlongX ? refBox.halfWidth : refBox.halfHeight);
+    Vector2<T> tangent = refAlongX ? refBox.axisY : refBox.axisX;
+    T faceHalfLength = refAlongX ? refBox.halfHeight : refBox.halfWidth;
+
+    // Incident face is the one most opposed to the reference normal
+    T dotX = incBox.axisX.dot(refNormal);
+    T dotY = incBox.axisY.dot(refNormal);
+    Vector2<T> incidentPoints[2];
+    if (abs(dotX) > abs(dotY)) {
+        Vector2<T> faceNormal = dotX > T(0) ? incBox.axisX * T(-1) : incBox.axisX;
+        Vector2<T> mid = incBox.center + faceNormal * incBox.halfWidth;
+        incidentPoints[0] = mid + incBox.axisY * incBox.halfHeight;
+        incidentPoints[1] = mid - incBox.axisY * incBox.halfHeight;
+    } else {
+        Vector2<T> faceNormal = dotY > T(0) ? incBox.axisY * T(-1) : incBox.axisY;
+        Vector2<T> mid = incBox.center + faceNormal * incBox.halfHeight;
+        incidentPoints[0] = mid + incBox.axisX * incBox.halfWidth;
+        incidentPoints[1] = mid - incBox.axisX * incBox.halfWidth;
+    }
+
+    // Clip the incident edge to the side planes of the reference face
+    T centerT = faceCenter.dot(tangent);
+    for (int side = 0; side < 2; side++) {
+        T sign = side == 0 ? T(1) : T(-1);
+        T limit = sign * centerT + faceHalfLength;
+        T d0 = sign * incidentPoints[0].dot(tangent) - limit;
+        T d1 = sign * incidentPoints[1].dot(tangent) - limit;
+        if (d0 > T(0) && d1 > T(0)) return false;
+        if (d0 > T(0)) incidentPoints[0] = incidentPoints[0] + (incidentPoints[1] - incidentPoints[0]) * (d0 / (d0 - d1));
+        if (d1 > T(0)) incidentPoints[1] = incidentPoints[1] + (incidentPoints[0] - incidentPoints[1]) * (d1 / (d1 - d0));
+    }
+
+    // Keep clipped points that are behind the reference face
+    contact.pointCount = 0;
+    contact.depth = T(0);
+    for (const Vector2<T>& p : incidentPoints) {
+        T depth = -(p - faceCenter).dot(refNormal);
+        if (depth < T(0)) continue;
+        contact.points[contact.pointCount++] = p;
+        if (depth >= contact.depth) {
+            contact.depth = depth;
+            contact.point = p;
+        }
+    }
+    if (contact.pointCount == 0) return false;
+
+    // Report the normal from A to B
+    contact.normal = ref == 0 ? refNormal : refNormal * T(-1);
+    return true;
+}
+
+// Half-plane vs circle. Normal is the plane normal (plane to circle).
+template <typename T>
+bool planeVsCircle(const Vector2<T>& planePoint, const Vector2<T>& n, const Vector2<T>& center, T radius,
+                   BasicContact<T>& contact) {
+    contact.normal = n;
+    contact.pointCount = 0;
+    contact.depth = T(0);
+
+    T height = (center - planePoint).dot(n) - radius;
+    if (height >= T(0)) return false;
+    contact.depth = -height;
+    contact.point = center - n * radius;
+    contact.points[0] = contact.point;
+    contact.pointCount = 1;
+    return true;
+}
+
+// Half-plane vs oriented box: every corner behind the plane is a contact point
+// (at most two matter). Normal is the plane normal.
+template <typename T>
+bool planeVsBox(const Vector2<T>& planePoint, const Vector2<T>& n, const OrientedBox<T>& box,
+                BasicContact<T>& contact) {
+    contact.normal = n;
+    contact.pointCount = 0;
+    contact.depth = T(0);
+
+    const int signs[4][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+    for (const auto& sign : signs) {
+        Vector2<T> corner = box.center + box.axisX * (T(sign[0]) * box.halfWidth) + box.axisY * (T(sign[1]) * box.halfHeight);
+        T depth = -(corner - planePoint).dot(n);
+        if (depth <= T(0)) continue;
+        if (depth > contact.depth) {
+            contact.depth = depth;
+            contact.point = corner;
+        }
+        if (contact.pointCount < 2) {
+            contact.points[contact.pointCount++] = corner;
+        }
+    }
+    return contact.pointCount > 0;
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include "Physics.h"
+#include "RigidBody.h"
+#include <cstdint>
+#include <vector>
+
+// Fast path for large numbers of identical, non-rotating circles (sand, beads,
+// the balls in the cup demo). Particles are stored structure-of-arrays and have
+// no vtable, collider or per-particle allocation.
+//
+// Every step the particles are counting-sorted into a dense cell grid whose cells
+// are at least one diameter wide, so neighbours are always in the 3x3 block
+// around a particle's cell and each block row is a contiguous array range.
+// Periodic bounds wrap the block (a wrapped axis under three cells is searched
+// whole), and rigid bodies near a seam also collide through their wrapped copy.
+// Contacts are solved Jacobi-style (each particle only writes its own
+// correction), so the neighbour pass runs in parallel without locks.
+// Rigid bodies passed to step() are coupled both ways: particles push dynamic
+// bodies back with the same impulse they receive.
+class ParticleSystem {
+    private:
+        float radius;
+        float mass;
+        float restitution;
+        int iterations;
+        uint16_t categoryBits;
+        uint16_t maskBits;
+
+        // Particle state (SoA), kept in grid order after every step
+        std::vector<float> posX, posY, velX, velY;
+        std::vector<uint32_t> ids;  // Original insertion index of each slot
+
+        // Grid and scratch buffers, reused between steps
+        std::vector<int> cellOf;
+        std::vector<int> cellStart;
+        std::vector<int> destination;
+        std::vector<float> scratch;
+        std::vector<uint32_t> scratchIds;
+        std::vector<float> corrX, corrY, deltaVX, deltaVY;
+        mutable std::vector<float> drawBuffer;
+        int gridW = 0, gridH = 0;
+        float gridMinX = 0.0f, gridMinY = 0.0f;
+        float cellW = 1.0f, cellH = 1.0f;
+        bool wrapX = false, wrapY = false;
+        float periodX = 0.0f, periodY = 0.0f;
+
+        void integrate(float dt, const Vector2D& gravity);
+        void buildGrid(const Physics& physics);
+        void solveParticles(bool applyVelocity);
+        void collideBody(RigidBody& body);
+        void collideBounds(const Physics& physics);
+
+    public:
+        ParticleSystem(float radius, float mass, float restitution = 0.6f);
+
+        void reserve(int count);
+        int addParticle(const Vector2D& pos, const Vector2D& vel = Vector2D());
+        void clear();
+
+        int getCount() const { return static_cast<int>(posX.size()); }
+        float getRadius() const { return radius; }
+        float getMass() const { return mass; }
+        float getRestitution() const { return restitution; }
+
+        // Slots are reordered every step; getId() maps a slot to its insertion index
+        Vector2D getPosition(int slot) const { return Vector2D(posX[slot], posY[slot]); }
+        Vector2D getVelocity(int slot) const { return Vector2D(velX[slot], velY[slot]); }
+        uint32_t getId(int slot) const { return ids[slot]; }
+        void setPosition(int slot, const Vector2D& pos) { posX[slot] = pos.x; posY[slot] = pos.y; }
+        void setVelocity(int slot, const Vector2D& vel) { velX[slot] = vel.x; velY[slot] = vel.y; }
+
+        // Raw SoA arrays for external consumers (rendering, export)
+        const float* getPositionsX() const { return posX.data(); }
+        const float* getPositionsY() const { return posY.data(); }
+        const float* getVelocitiesX() const { return velX.data(); }
+        const float* getVelocitiesY() const { return velY.data(); }
+
+        void setRestitution(float r) { restitution = r; }
+        void setIterations(int count) { iterations = count < 1 ? 1 : count; }
+        void setFilter(uint16_t category, uint16_t mask) { categoryBits = category; maskBits = mask; }
+
+        // Uses the world's gravity and boundaries; bodies are the rigid bodies to couple with
+        void step(float dt, const Physics& physics, std::vector<RigidBody*>& bodies);
+        void draw() const;
+};
+
+#endif
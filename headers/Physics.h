@@ -2,20 +2,159 @@
 #define PHYSICS_H
 #include "RigidBody.h"
 #include "CircleCollider.h"
+#include "PlaneCollider.h"
+#include "Contact.h"
+#include "ContactCache.h"
+#include "Query.h"
+#include "Rollback.h"
+#include "SpatialGrid.h"
+#include <functional>
 #include <vector>
 
+class StateExporter;
+
+// How each side of the world box behaves
+enum class BoundarySide {
+    Left,
+    Right,
+    Bottom,
+    Top
+};
+
+enum class BoundaryMode {
+    Solid,     // Static half-plane collider
+    Open,      // Nothing; bodies leave the world
+    Periodic   // Wraps around to the opposite side (applies to both sides of the axis)
+};
+
 class Physics {
     private: 
-        int worldWidth;
-        int worldHeight;
+        float worldWidth;
+        float worldHeight;
         Vector2D gravity;
 
+        // World bounds are ordinary static bodies with plane colliders
+        PlaneCollider boundaryPlanes[4];
+        RigidBody boundaryBodies[4];
+        BoundaryMode boundaryModes[4];
+        std::vector<RigidBody*> stepBodies;  // Caller's bodies plus the solid boundaries
+
+        void configureBroadphase();
+        void wrapPeriodic(RigidBody& body) const;
+        SpatialGrid broadphase;
+        bool broadphaseEnabled = true;
+
+        // Per-pair manifolds, separating axes and impulses, persisted across steps
+        ContactCache contactCache;
+        std::vector<ContactEvent> contactEvents;
+        bool contactEventsEnabled = false;
+        unsigned frame = 0;
+        StateExporter* stateExport = nullptr;
+
+        RollbackHistory rollback;
+        bool rollbackEnabled = false;
+        bool resimulating = false;
+        std::vector<RigidBody*> partialBodies;
+        const RollbackFrame* partialFrame = nullptr;  // Replayed frame of the partial step in progress
+
+        void gatherStepBodies(const std::vector<RigidBody*>& bodies);
+
+        void collidePair(RigidBody* bodyA, RigidBody* bodyB, Vector2D shiftB = Vector2D());
+        void updatePair(ContactPair* pair);
+
+        // Distance along a unit ray until it leaves every body's bounds
+        float clipToWorld(const Vector2D& origin, const Vector2D& dir, float maxDistance, float margin) const;
+
     public:
         Physics(float width, float height, const Vector2D& grav = Vector2D(0, -9.8f));
+        // Boundary bodies point at member colliders, so a world cannot be copied
+        Physics(const Physics&) = delete;
+        Physics& operator=(const Physics&) = delete;
+
+        float getWorldWidth() const { return worldWidth; }
+        float getWorldHeight() const { return worldHeight; }
+        const Vector2D& getGravity() const { return gravity; }
+
+        void setBoundary(BoundarySide side, BoundaryMode mode);
+        BoundaryMode getBoundary(BoundarySide side) const { return boundaryModes[static_cast<int>(side)]; }
+        const RigidBody& getBoundaryBody(BoundarySide side) const { return boundaryBodies[static_cast<int>(side)]; }
+
+        // Resolves a single body against the world bounds outside of step()
         void checkWallCollisions(RigidBody& body);
         void checkBodyCollisions(std::vector<RigidBody*>& bodies);
         void applyGravity(RigidBody& body);
-        
+
+        // Gravity, integration, periodic wrap and collisions (bounds included) for one fixed step
+        void step(std::vector<RigidBody*>& bodies, float dt);
+
+        // The grid broadphase is on by default; off falls back to testing every pair
+        void setBroadphaseEnabled(bool enabled) { broadphaseEnabled = enabled; }
+        bool isBroadphaseEnabled() const { return broadphaseEnabled; }
+
+        // ------------------ Contact events ------------------
+        // When enabled, every step fills a buffer of Begin/Persist/End events
+        // (sensor overlaps included) that stays valid until the next step.
+        void setContactEventsEnabled(bool enabled);
+        const std::vector<ContactEvent>& getContactEvents() const { return contactEvents; }
+
+        // Cached pairs from the last step; clear after teleporting bodies (e.g. a scene reset)
+        const ContactCache& getContactCache() const { return contactCache; }
+        void clearContacts();
+        // Drops the cached pairs, pending events, query proxies and rollback history that
+        // point at these bodies (no End events are sent). Call before freeing stepped bodies.
+        void forgetBodies(const std::vector<RigidBody*>& bodies);
+
+        // ------------------ State export ------------------
+        // When set, every step ends by publishing the bodies it was given to the
+        // exporter's shared memory (see StateExport.h). Pass null to stop.
+        void setStateExport(StateExporter* exporter) { stateExport = exporter; }
+
+        // ------------------ Rollback ------------------
+        // When enabled, step() records the last historyFrames steps of the body list
+        // it is given: the bodies each step changed (before and after) plus the
+        // contact cache. Stepping a different list starts a new history.
+        void setRollbackEnabled(bool enabled, int historyFrames = 60);
+        unsigned getFrame() const { return frame; }
+        unsigned getOldestRollbackFrame() const { return rollback.getOldestFrame(); }
+
+        // Puts bodies, contacts and the frame counter back to the end of an
+        // earlier step. False if that frame is no longer recorded.
+        bool rewind(unsigned targetFrame);
+        // After rewind(): bodies whose state or inputs were corrected. Anything
+        // changed without being marked replays its old path during resimulate().
+        void markDirty(const RigidBody* body) { rollback.markDirty(body); }
+        void markAllDirty() { rollback.markAllDirty(); }
+
+        // Steps back up to toFrame without contact events or state export.
+        // onFrame(frame) runs before the step that produces frame, to re-apply
+        // inputs. Only dirty bodies and the bodies they may touch are stepped;
+        // the rest replay the recorded timeline.
+        void resimulate(std::vector<RigidBody*>& bodies, unsigned toFrame, float dt,
+                        const std::function<void(unsigned frame)>& onFrame = nullptr);
+        // Bodies the last resimulate() actually stepped
+        int getDirtyCount() const { return rollback.getDirtyCount(); }
+
+        // ------------------ Spatial queries ------------------
+        // Queries run against the bodies passed to the last updateBroadphase() call.
+        // Directions do not need to be normalized; distances are in meters.
+        void updateBroadphase(const std::vector<RigidBody*>& bodies);
+        SpatialGrid& getBroadphase() { return broadphase; }
+
+        bool raycast(const Vector2D& origin, const Vector2D& dir, float maxDistance, RaycastHit& hit) const;
+        int raycastAll(const Vector2D& origin, const Vector2D& dir, float maxDistance,
+                       std::vector<RaycastHit>& hits) const;  // Sorted by distance
+        // Closest hit per ray, computed in parallel; hits[i].body is null on a miss.
+        // Safe from any thread (the shared pool serializes jobs and runs nested ones inline).
+        void raycastBatch(const std::vector<Ray>& rays, std::vector<RaycastHit>& hits) const;
+
+        bool circleCast(const Vector2D& origin, float radius, const Vector2D& dir, float maxDistance,
+                        RaycastHit& hit) const;
+        bool boxCast(const Vector2D& origin, const Vector2D& halfExtents, float angle, const Vector2D& dir,
+                     float maxDistance, RaycastHit& hit) const;
+
+        int queryRegion(const AABB& region, std::vector<RigidBody*>& results) const;
+        int queryPoint(const Vector2D& point, std::vector<RigidBody*>& results) const;
+
 };
 
 #endif
\ No newline at end of file
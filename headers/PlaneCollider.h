@@ -0,0 +1,15 @@
+#pragma once
+#include "Collider.h"
+
+// Infinite half-plane through the owning body's position.
+// The normal points into open space; everything behind it is solid.
+class PlaneCollider : public Collider {
+private:
+    Vector2D normal;
+
+public:
+    PlaneCollider(const Vector2D& n)
+        : Collider(ColliderType::Plane), normal(n) {}
+
+    Vector2D getNormal() const override { return normal; }
+};
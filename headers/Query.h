@@ -0,0 +1,35 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "Vector2D.h"
+#include <limits>
+
+class RigidBody;
+
+// A ray for batched queries. dir does not need to be normalized.
+struct Ray {
+    Vector2D origin;
+    Vector2D dir;
+    float maxDistance = std::numeric_limits<float>::infinity();
+};
+
+// Result of a ray or shape cast. distance is measured along the normalized
+// direction; a cast that starts overlapping a body reports distance 0.
+struct RaycastHit {
+    RigidBody* body = nullptr;
+    Vector2D point;
+    Vector2D normal;    // Surface normal of the hit body, facing the caster
+    float distance = 0.0f;
+};
+
+// Exact per-shape tests against a single body (circles and rotated rectangles).
+// dir must be unit length. Return true and fill distance/normal on a hit within maxDistance.
+bool raycastBody(const RigidBody& body, const Vector2D& origin, const Vector2D& dir,
+                 float maxDistance, float& distance, Vector2D& normal);
+bool circleCastBody(const RigidBody& body, const Vector2D& origin, float radius, const Vector2D& dir,
+                    float maxDistance, float& distance, Vector2D& normal);
+bool boxCastBody(const RigidBody& body, const Vector2D& origin, const Vector2D& halfExtents, float angle,
+                 const Vector2D& dir, float maxDistance, float& distance, Vector2D& normal);
+bool bodyContainsPoint(const RigidBody& body, const Vector2D& point);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Counter-based random numbers: every value is a pure function of (seed, counter),
+// so any body can be re-randomized independently and in any order.
+
+// SplitMix64 finalizer applied to seed + counter
+inline uint64_t counterRandom(uint64_t seed, uint64_t counter) {
+    uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform float in [0, 1) built from the top 24 bits
+inline float counterUniform(uint64_t seed, uint64_t counter) {
+    return static_cast<float>(counterRandom(seed, counter) >> 40) * (1.0f / 16777216.0f);
+}
+
+#endif
@@ -2,9 +2,21 @@
 #define RIGIDBODY_H
 
 #include "Vector2D.h"
+#include "AABB.h"
+#include <cstdint>
 
 class Collider; // Forward declaration
 
+// Plain-old-data snapshot of everything that changes while simulating.
+// Trivially copyable so whole scenes can be saved/restored as flat arrays.
+struct BodyState {
+    Vector2D position;
+    Vector2D velocity;
+    Vector2D acceleration;
+    float angle;
+    float angularV;
+};
+
 class RigidBody{
     protected:
         Vector2D position;
@@ -20,6 +32,19 @@ class RigidBody{
         float inertia;
         
         Collider* collider = nullptr;
+
+        // Derived from angle and collider, and refreshed only when one of them
+        // changes, so a body that never turns does its trig once
+        float cosAngle = 1.0f;
+        float sinAngle = 0.0f;
+        Vector2D halfExtents;  // Half size of the world AABB (rotated shape)
+        void refreshTransform();
+        AABB boundsAround(const Vector2D& at, const Vector2D& extents) const;
+
+        // Stable identity used to key per-pair caches. Copies keep the id, since
+        // copying a body into a container is still the same logical body.
+        uint32_t id;
+        static uint32_t nextId;
     
     public:
         static float pixelsPerMeter;  // Scale factor for rendering
@@ -33,16 +58,25 @@ class RigidBody{
         float getRestitution() const;
         float getFriction() const;
         float getAngle() const;
+        float getCosAngle() const;
+        float getSinAngle() const;
         bool isStaticBody() const;
         Collider* getCollider() const;
+        uint32_t getId() const;
+        BodyState getState() const;
+        AABB getAABB() const;
+        AABB getAABBAt(const BodyState& state) const;  // As if setState(state) had been called, without copying
         
         void setPosition(const Vector2D& pos);
         void setVelocity(const Vector2D& vel);
         void setAcceleration(const Vector2D& acc);
         void setRestitution(float r);
         void setFriction(float f);
+        void setStatic(bool s);
         void setAngle(float a);
         void setCollider(Collider* c);
+        void setState(const BodyState& state);
+        void assignNewId();  // Gives a copied body its own identity
         void update(float dt);
         void applyForce(const Vector2D& force);
         virtual void draw() const;
@@ -0,0 +1,116 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "ContactCache.h"
+#include "RigidBody.h"
+#include "SpatialGrid.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// What one step changed: the bodies whose state differs from the step before
+// (with both values, so the step can be undone and redone) and the contact
+// cache as it was at the end of the step (occupied pairs only)
+struct RollbackFrame {
+    unsigned frame = 0;
+    std::vector<uint32_t> changed;  // Indices into the tracked body list
+    std::vector<BodyState> before;
+    std::vector<BodyState> after;
+    std::vector<ContactPair> contacts;
+};
+
+// Ring buffer of RollbackFrames for one body list, used by Physics::rewind()
+// and Physics::resimulate().
+//
+// After a rewind the undone frames are kept as the "replay" of the old
+// timeline. While resimulating, bodies not marked dirty just take their
+// replayed states. A clean body becomes dirty when its path comes near a
+// dirty body that has left its old path, and a dirty body that is back on its
+// old path with nothing diverged near it turns clean again. Only dirty bodies
+// are stepped, with the static bodies and their clean neighbours as ghosts
+// (dynamic for the step, then put back on the old timeline, as with
+// DistributedWorld's halo).
+class RollbackHistory {
+    private:
+        std::vector<RollbackFrame> ring;
+        int head = 0;   // Oldest frame
+        int count = 0;
+
+        std::vector<RigidBody*> tracked;
+        std::vector<BodyState> lastStates;  // Tracked bodies as of the newest frame
+        std::unordered_map<uint32_t, int> indexOfId;
+
+        // Old timeline while rewound (the first replayCount entries)
+        std::vector<RollbackFrame> replay;
+        size_t replayCount = 0;
+        size_t replayNext = 0;
+        std::vector<BodyState> shadow;      // Old-timeline state of every body at the current frame
+        std::vector<uint8_t> dirty;
+        int dirtyCount = 0;
+        bool allDirty = false;
+
+        // Scratch for dirty propagation
+        SpatialGrid grid;
+        std::vector<RigidBody*> gridBodies;
+        std::vector<int> gridIndex;
+        std::vector<int> entryOf;
+        std::vector<int> worklist;
+        std::vector<uint8_t> touched;
+        std::vector<int> border;  // Clean bodies stepped as ghosts
+        std::vector<float> sizes;
+
+        RollbackFrame& slot(int i) { return ring[(head + i) % ring.size()]; }
+        const RollbackFrame& slot(int i) const { return ring[(head + i) % ring.size()]; }
+        AABB pathBounds(int index, const RollbackFrame& next, float dt, float margin) const;
+        bool isDirty(const RigidBody* body) const;
+        bool isBorder(const RigidBody* body) const;
+
+    public:
+        explicit RollbackHistory(int capacity = 60);
+
+        void setCapacity(int frames);
+        int getCapacity() const { return static_cast<int>(ring.size()); }
+        void clear();
+
+        bool isTracking(const std::vector<RigidBody*>& bodies) const;
+        bool tracks(const RigidBody* body) const;
+        // Starts a new history for this body list; the current states become frame `frame`
+        void begin(const std::vector<RigidBody*>& bodies, unsigned frame, const ContactCache& cache);
+        // Appends the step that produced `frame`, dropping the oldest when full
+        void record(unsigned frame, const ContactCache& cache);
+
+        bool empty() const { return count == 0; }
+        unsigned getOldestFrame() const { return count ? slot(0).frame : 0; }
+        unsigned getNewestFrame() const { return count ? slot(count - 1).frame : 0; }
+
+        // Undoes every frame after target, keeping them as the replay. Restores
+        // the bodies and the contact cache; false if target was not recorded.
+        bool rewind(unsigned target, ContactCache& cache);
+
+        // ------------------ Resimulation ------------------
+        bool hasReplay() const { return replayNext < replayCount; }
+        // The old timeline's record of the step producing frame, if there is one
+        const RollbackFrame* takeReplay(unsigned frame);
+        void endReplay();
+
+        // Only valid while rewound; static and untracked bodies are ignored
+        void markDirty(const RigidBody* body);
+        void markAllDirty() { allDirty = true; }
+        bool isAllDirty() const { return allDirty; }
+        int getDirtyCount() const { return allDirty ? static_cast<int>(tracked.size()) : dirtyCount; }
+
+        // Updates the dirty set for the step replayed by next (margin covers
+        // contact slop and gravity within the step)
+        void propagateDirty(const RollbackFrame& next, float dt, float margin);
+        // Static, dirty and ghost bodies for the partial step; also puts the
+        // replayed clean pairs into the cache
+        void beginPartialStep(const RollbackFrame& next, ContactCache& cache, std::vector<RigidBody*>& out) const;
+        // After the partial step: clean bodies and ghosts take the replayed values
+        void endPartialStep(const RollbackFrame& next, ContactCache& cache);
+        // Broadphase cell size a full step would pick, called once the partial
+        // step has integrated. Grid pairs are resolved in an order that depends
+        // on the cell size, so the partial step must use the same one.
+        float fullStepCellSize(const RollbackFrame& next);
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef SCENEFILE_H
+#define SCENEFILE_H
+
+#include "Collider.h"
+#include "Physics.h"
+#include "SceneTemplate.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ------------------ Scene file format ------------------
+// Text form, one statement per line, '#' starts a comment. Names and shapes
+// must be declared before a body or spawner uses them. Angles are radians,
+// and every number must be finite (nan and inf are errors).
+//
+//   world <width> <height>                  meters (default 16 12)
+//   gravity <x> <y>                         default 0 -9.8
+//   boundary <left|right|bottom|top|all> <solid|open|periodic>
+//   broadphase <on|off>
+//   timestep <seconds>                      default 1/60
+//   seed <n>                                fixed episode seed (default: clock)
+//
+//   material <name> <restitution> <friction>
+//   circle <name> <radius> [sensor] [filter <category> <mask>]
+//   rect <name> <width> <height> [sensor] [filter <category> <mask>]
+//
+//   body <shape> <material> <x> <y> [mass <m>] [angle <a>] [velocity <vx> <vy>] [static]
+//   spawn <shape> <material> <count> <minX> <minY> <maxX> <maxY>
+//         [mass <m>] [angle <min> <max>] [velocity <minX> <minY> <maxX> <maxY>]
+//
+// Bodies fill the template first, then spawners in file order. Spawners
+// become SceneTemplate randomizers, so every reset re-rolls them.
+// The engine has no joints yet; a "joint" line is reported as an error rather
+// than silently dropped.
+//
+// Compiled form (.scnb): "SCN1", a version, the settings and four counts,
+// then the material, shape, body and spawner records below written as raw
+// arrays in native byte order. It loads with a handful of reads.
+
+struct SceneSettings {
+    float width = 16.0f;
+    float height = 12.0f;
+    Vector2D gravity = Vector2D(0, -9.8f);
+    float timestep = 1.0f / 60.0f;
+    uint8_t boundaries[4] = {0, 0, 0, 0};  // BoundaryMode per BoundarySide
+    uint8_t broadphase = 1;
+    uint8_t hasSeed = 0;
+    uint8_t padding[6] = {0, 0, 0, 0, 0, 0};
+    uint64_t seed = 0;
+};
+
+struct SceneMaterial {
+    char name[32];
+    float restitution;
+    float friction;
+};
+
+struct SceneShape {
+    char name[32];
+    uint32_t type;        // ColliderType
+    float width;          // Radius for circles
+    float height;
+    uint16_t category;
+    uint16_t mask;
+    uint32_t sensor;
+};
+
+struct SceneBody {
+    uint32_t shape;
+    uint32_t material;
+    Vector2D position;
+    Vector2D velocity;
+    float angle;
+    float mass;
+    uint32_t isStatic;
+};
+
+struct SceneSpawner {
+    uint32_t shape;
+    uint32_t material;
+    uint32_t count;
+    float mass;
+    Vector2D minPosition;
+    Vector2D maxPosition;
+    float minAngle;
+    float maxAngle;
+    Vector2D minVelocity;
+    Vector2D maxVelocity;
+};
+
+// A parsed scene. Owns one collider per shape, made when the scene loads, so
+// it must outlive every body built from it; loading again or clear() frees them.
+class SceneFile {
+    private:
+        SceneSettings settings;
+        std::vector<SceneMaterial> materials;
+        std::vector<SceneShape> shapes;
+        std::vector<SceneBody> bodies;
+        std::vector<SceneSpawner> spawners;
+        std::vector<std::unique_ptr<Collider>> colliders;
+
+        bool parseLine(char* line, const char* path, int lineNumber);
+        void createColliders();
+        int findMaterial(const char* name) const;
+        int findShape(const char* name) const;
+
+    public:
+        // Sniffs the first bytes and picks the text or compiled loader.
+        // Errors go to stderr as path:line: message; on failure the scene is empty.
+        bool load(const char* path);
+        bool loadText(const char* path);
+        bool loadCompiled(const char* path);
+        bool saveCompiled(const char* path) const;
+        void clear();
+
+        const SceneSettings& getSettings() const { return settings; }
+        // Total bodies once built, spawned ones included
+        int getBodyCount() const;
+
+        // World size and gravity go to the Physics constructor; this sets the rest
+        void configure(Physics& physics) const;
+        // Adds every body and spawner to the template (not compiled yet). May be
+        // called for any number of templates; they all share this scene's colliders.
+        // Returns false if the template rejects a spawner's ranges.
+        bool build(SceneTemplate& scene) const;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SCENETEMPLATE_H
+#define SCENETEMPLATE_H
+
+#include "RigidBody.h"
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<BodyState>::value, "BodyState must stay memcpy-able");
+
+// Which part of a body's state a randomizer rewrites on reset
+enum class RandomField {
+    Position,
+    Velocity,
+    Angle
+};
+
+// Scene description that is built once and then reset many times.
+// compile() flattens the initial state of every body into one BodyState array;
+// reset() copies that image back and re-rolls the randomized fields with a
+// counter-based RNG, so no bodies or colliders are allocated per episode.
+class SceneTemplate {
+    private:
+        struct Randomizer {
+            RandomField field;
+            int first;
+            int count;
+            Vector2D minValue;   // For Angle only minValue.x / maxValue.x are used
+            Vector2D maxValue;
+        };
+
+        std::vector<RigidBody> prototypes;
+        std::vector<BodyState> image;
+        std::vector<Randomizer> randomizers;
+        bool compiled = false;
+
+    public:
+        // Adds a body (or count copies of it) and returns the index of the first one.
+        // Colliders are shared between the template and every instance, not copied.
+        int addBody(const RigidBody& body);
+        int addBodies(const RigidBody& body, int count);
+        // Avoids regrowing the prototype array when the final size is known up front
+        void reserve(int count) { prototypes.reserve(count); }
+
+        // Re-roll a field uniformly in [minValue, maxValue] for bodies [first, first + count).
+        // The bodies must already be added and min <= max per component; false otherwise.
+        bool randomize(RandomField field, int first, int count,
+                       const Vector2D& minValue, const Vector2D& maxValue);
+
+        void compile();
+        bool isCompiled() const { return compiled; }
+        int getBodyCount() const { return static_cast<int>(prototypes.size()); }
+        const std::vector<BodyState>& getImage() const { return image; }
+
+        // Builds the body array once (allocates), then resets it
+        void instantiate(std::vector<RigidBody>& bodies, uint64_t seed) const;
+
+        // Restores bodies created by instantiate() to a fresh episode; no allocation
+        void reset(std::vector<RigidBody>& bodies, uint64_t seed) const;
+};
+
+#endif
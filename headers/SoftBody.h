@@ -0,0 +1,114 @@
+#ifndef SOFTBODY_H
+#define SOFTBODY_H
+
+#include "Physics.h"
+#include "RigidBody.h"
+#include "AABB.h"
+#include <cstdint>
+#include <vector>
+
+// Stiffness is given as XPBD compliance (inverse stiffness, m/N).
+// 0 is rigid, larger values are softer.
+struct SoftBodyMaterial {
+    float stretchCompliance = 0.0f;    // Edge length
+    float areaCompliance = 0.0f;       // Triangle area (jelly volume)
+    float bendingCompliance = 1e-4f;   // Distance across two edges
+    float particleRadius = 0.02f;      // Collision thickness
+    float friction = 0.3f;             // 0 slides freely, 1 sticks
+};
+
+enum class SoftConstraintType {
+    Distance,
+    Area,
+    Bending
+};
+
+// Every constraint touches at most three particles; distance and bending use p[0] and p[1]
+struct SoftConstraint {
+    SoftConstraintType type;
+    int p[3];
+    float rest;
+    float compliance;
+};
+
+// One mesh: a contiguous run of particles in the shared arrays
+struct SoftBodyRange {
+    int firstParticle;
+    int particleCount;
+    float radius;
+    float friction;
+    AABB bounds;  // Refreshed every substep, padded by radius
+};
+
+// Position based (XPBD) soft bodies: cloth, jelly blocks, ropes.
+// All meshes share one set of SoA particle arrays and one constraint list.
+// Constraints are greedily graph-colored so no two in the same color share a
+// particle; each color is then solved in parallel with no locks. Stepping uses
+// many substeps with one constraint pass each, which keeps stiff meshes stable
+// without keeping Lagrange multipliers around between substeps.
+//
+// Rigid bodies collide with the particles as infinitely heavy obstacles (soft
+// bodies do not push them back) and the world's solid bounds are respected.
+class SoftBodySystem {
+    private:
+        // Particle state (SoA)
+        std::vector<float> posX, posY, prevX, prevY, velX, velY, invMass;
+
+        std::vector<SoftBodyRange> softBodies;
+        std::vector<SoftConstraint> constraints;  // Sorted by color once colored
+        std::vector<int> colorStart;              // Constraint range of each color
+        bool colorsDirty = false;
+        bool lastColorSerial = false;             // Overflow color shares particles
+
+        int substeps;
+        uint16_t categoryBits;
+        uint16_t maskBits;
+
+        void colorConstraints();
+        void solveConstraint(const SoftConstraint& c, float alpha);
+        void updateBounds(SoftBodyRange& body);
+        void collideBodies(SoftBodyRange& body, const std::vector<RigidBody*>& bodies, float h);
+        void collideBounds(SoftBodyRange& body, const Physics& physics, float h);
+        void applyFriction(int i, float nx, float ny, const Vector2D& surfaceVel, float friction, float h);
+
+    public:
+        SoftBodySystem();
+
+        // Building blocks: particles are added to the body opened by the last beginBody()
+        int beginBody(const SoftBodyMaterial& material);
+        int addParticle(const Vector2D& pos, float mass);  // mass <= 0 pins the particle
+        void addDistanceConstraint(int a, int b, float compliance);
+        void addAreaConstraint(int a, int b, int c, float compliance);
+        void addBendingConstraint(int a, int b, float compliance);
+
+        // Triangulated grid of columns x rows particles with area constraints; returns the body index
+        int addBlock(const Vector2D& center, float width, float height, int columns, int rows,
+                     float totalMass, const SoftBodyMaterial& material);
+        // Hanging sheet from its top-left corner, optionally pinned along the top row
+        int addCloth(const Vector2D& topLeft, int columns, int rows, float spacing,
+                     float totalMass, const SoftBodyMaterial& material, bool pinTop = true);
+        void clear();
+
+        int getParticleCount() const { return static_cast<int>(posX.size()); }
+        int getBodyCount() const { return static_cast<int>(softBodies.size()); }
+        int getConstraintCount() const { return static_cast<int>(constraints.size()); }
+        int getColorCount() const { return colorStart.empty() ? 0 : static_cast<int>(colorStart.size()) - 1; }
+        const SoftBodyRange& getBody(int index) const { return softBodies[index]; }
+
+        Vector2D getPosition(int i) const { return Vector2D(posX[i], posY[i]); }
+        Vector2D getVelocity(int i) const { return Vector2D(velX[i], velY[i]); }
+        void setPosition(int i, const Vector2D& pos) { posX[i] = prevX[i] = pos.x; posY[i] = prevY[i] = pos.y; }
+        void setVelocity(int i, const Vector2D& vel) { velX[i] = vel.x; velY[i] = vel.y; }
+        const float* getPositionsX() const { return posX.data(); }
+        const float* getPositionsY() const { return posY.data(); }
+
+        void setSubsteps(int count) { substeps = count < 1 ? 1 : count; }
+        int getSubsteps() const { return substeps; }
+        void setFilter(uint16_t category, uint16_t mask) { categoryBits = category; maskBits = mask; }
+
+        // Uses the world's gravity and bounds; bodies are the rigid obstacles
+        void step(float dt, const Physics& physics, const std::vector<RigidBody*>& bodies);
+        void draw() const;
+};
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include "AABB.h"
+#include "Collider.h"
+#include "RigidBody.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Uniform hashed grid used as the broadphase.
+// Rebuilt from scratch every step with a counting sort: each body's AABB is
+// binned into every cell it touches, and buckets are stored as one flat array.
+// Bodies that would cover too many cells (long ramps, floors) are kept in a
+// separate "large" list and tested against everything instead.
+//
+// With periodic axes, bodies near the low edge of the domain also get a ghost
+// proxy shifted by one period, so pairs across the seam are found exactly once.
+class SpatialGrid {
+    public:
+        struct Proxy {
+            AABB bounds;
+            RigidBody* body;
+            int x0, y0, x1, y1;  // Covered cell range (inclusive)
+            uint16_t categoryBits;
+            uint16_t maskBits;
+            bool large;
+            bool ghost;       // Periodic copy of another proxy
+            int source;       // Real proxy a ghost copies (its own index otherwise)
+            Vector2D offset;  // Shift from the body's real position to this proxy
+        };
+
+        static const int maxCellsPerProxy = 64;
+
+    private:
+        float cellSize;       // Requested size, 0 = pick from body sizes
+        float activeCellSize;
+        float invCellSize;
+
+        std::vector<Proxy> proxies;
+        std::vector<int> largeProxies;
+        std::vector<int> cellStart;    // Offsets into cellEntries, one per bucket + 1
+        std::vector<int> cellEntries;  // Proxy indices grouped by bucket
+        std::vector<float> sizeScratch;
+        std::vector<int> bucketStamp;
+        std::vector<int> bucketCursor;
+        unsigned bucketMask = 0;
+        AABB gridBounds;               // Union of all binned proxies
+        AABB allBounds;                // Union of every finite proxy, large ones included
+
+        bool periodicX = false;
+        bool periodicY = false;
+        AABB periodicDomain;
+
+        void addGhosts();
+        int cellCoord(float v) const {
+            float c = std::floor(v * invCellSize);
+            c = std::max(-1073741824.0f, std::min(1073741823.0f, c));
+            return static_cast<int>(c);
+        }
+
+        unsigned bucketOf(int cx, int cy) const {
+            uint32_t h = static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u;
+            return h & bucketMask;
+        }
+
+        static bool canCollide(const Proxy& a, const Proxy& b) {
+            return Collider::shouldCollide(a.categoryBits, a.maskBits, b.categoryBits, b.maskBits);
+        }
+
+        static bool covers(const Proxy& p, int cx, int cy) {
+            return cx >= p.x0 && cx <= p.x1 && cy >= p.y0 && cy <= p.y1;
+        }
+
+        void chooseCellSize(float autoSize);
+
+    public:
+        explicit SpatialGrid(float cellSize = 0.0f);
+
+        void setCellSize(float size) { cellSize = size; }
+        // Size an unset cellSize resolves to for bodies of these extents (0 if none
+        // are finite). Reorders sizes.
+        static float autoCellSize(std::vector<float>& sizes);
+
+        // Wrap-around axes; bodies are expected to stay inside domain on those axes
+        void setPeriodic(bool wrapX, bool wrapY, const AABB& domain);
+        float getCellSize() const { return activeCellSize; }
+
+        // autoSize, when positive, replaces the size picked from these bodies'
+        // extents (a set cellSize still wins)
+        void build(const std::vector<RigidBody*>& bodies, float autoSize = 0.0f);
+
+        int getProxyCount() const { return static_cast<int>(proxies.size()); }
+        const Proxy& getProxy(int index) const { return proxies[index]; }
+        const AABB& getBounds() const { return allBounds; }
+
+        // Calls visit(proxyIndex) once for every proxy whose AABB overlaps region
+        template<class Visit>
+        void query(const AABB& region, Visit&& visit) const;
+
+        // Whether this proxy is the first of its body's images (the real proxy, then its
+        // ghosts in order) to overlap region, so queries can report each body once
+        bool firstImageIn(int index, const AABB& region) const {
+            const Proxy& p = proxies[index];
+            if (!p.ghost) return true;
+            if (proxies[p.source].bounds.overlaps(region)) return false;
+            for (int j = index - 1; proxies[j].ghost && proxies[j].source == p.source; j--) {
+                if (proxies[j].bounds.overlaps(region)) return false;
+            }
+            return true;
+        }
+
+        // Walks the cells under a ray (unit dir) in order. visit(proxyIndex) returns the
+        // distance the ray still needs to reach, so closest-hit queries can stop early.
+        // A proxy spanning several cells may be visited more than once.
+        template<class Visit>
+        void raycast(const Vector2D& origin, const Vector2D& dir, float maxDistance, Visit&& visit) const;
+
+        // Calls visit(a, b) with a < b once for every pair of proxies whose AABBs overlap
+        // and whose collision filters accept each other
+        template<class Visit>
+        void findPairs(Visit&& visit) const;
+};
+
+template<class Visit>
+void SpatialGrid::query(const AABB& region, Visit&& visit) const {
+    for (int index : largeProxies) {
+        if (proxies[index].bounds.overlaps(region)) visit(index);
+    }
+
+    int qx0 = cellCoord(region.min.x), qy0 = cellCoord(region.min.y);
+    int qx1 = cellCoord(region.max.x), qy1 = cellCoord(region.max.y);
+
+    // Huge regions: scanning the proxy list is cheaper than walking empty cells
+    int64_t cellCount = (int64_t(qx1) - qx0 + 1) * (int64_t(qy1) - qy0 + 1);
+    if (cellCount > std::max<int64_t>(256, static_cast<int64_t>(cellEntries.size()))) {
+        for (int i = 0; i < static_cast<int>(proxies.size()); i++) {
+            if (!proxies[i].large && proxies[i].bounds.overlaps(region)) visit(i);
+        }
+        return;
+    }
+
+    for (int cy = qy0; cy <= qy1; cy++) {
+        for (int cx = qx0; cx <= qx1; cx++) {
+            unsigned bucket = bucketOf(cx, cy);
+            for (int k = cellStart[bucket]; k < cellStart[bucket + 1]; k++) {
+                int index = cellEntries[k];
+                const Proxy& p = proxies[index];
+                if (!covers(p, cx, cy)) continue;  // Hash collision
+                // Report each proxy only from the first cell shared with the region
+                if (cx != std::max(p.x0, qx0) || cy != std::max(p.y0, qy0)) continue;
+                if (p.bounds.overlaps(region)) visit(index);
+            }
+        }
+    }
+}
+
+template<class Visit>
+void SpatialGrid::raycast(const Vector2D& origin, const Vector2D& dir, float maxDistance, Visit&& visit) const {
+    float limit = maxDistance;
+    for (int index : largeProxies) {
+        limit = std::min(limit, static_cast<float>(visit(index)));
+    }
+    if (cellEntries.empty()) return;
+
+    // Clip the ray against the grid bounds so infinite rays terminate
+    float tEnter = 0.0f;
+    float tExit = limit;
+    const float o[2] = {origin.x, origin.y};
+    const float d[2] = {dir.x, dir.y};
+    const float lo[2] = {gridBounds.min.x, gridBounds.min.y};
+    const float hi[2] = {gridBounds.max.x, gridBounds.max.y};
+    for (int axis = 0; axis < 2; axis++) {
+        if (std::abs(d[axis]) < 1e-12f) {
+            if (o[axis] < lo[axis] || o[axis] > hi[axis]) return;
+            continue;
+        }
+        float t0 = (lo[axis] - o[axis]) / d[axis];
+        float t1 = (hi[axis] - o[axis]) / d[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+    }
+    if (tEnter > tExit) return;
+
+    // Amanatides-Woo traversal starting where the ray enters the grid
+    Vector2D start = origin + dir * tEnter;
+    int cx = cellCoord(start.x);
+    int cy = cellCoord(start.y);
+    int stepX = dir.x > 0 ? 1 : -1;
+    int stepY = dir.y > 0 ? 1 : -1;
+    const float inf = std::numeric_limits<float>::infinity();
+    float nextX = (cx + (stepX > 0 ? 1 : 0)) * activeCellSize;
+    float nextY = (cy + (stepY > 0 ? 1 : 0)) * activeCellSize;
+    float tMaxX = std::abs(dir.x) > 1e-12f ? (nextX - origin.x) / dir.x : inf;
+    float tMaxY = std::abs(dir.y) > 1e-12f ? (nextY - origin.y) / dir.y : inf;
+    float tDeltaX = std::abs(dir.x) > 1e-12f ? activeCellSize / std::abs(dir.x) : inf;
+    float tDeltaY = std::abs(dir.y) > 1e-12f ? activeCellSize / std::abs(dir.y) : inf;
+
+    float tCell = tEnter;
+    for (int steps = 0; steps < 1 << 20; steps++) {
+        if (tCell > std::min(limit, tExit)) break;
+
+        unsigned bucket = bucketOf(cx, cy);
+        for (int k = cellStart[bucket]; k < cellStart[bucket + 1]; k++) {
+            int index = cellEntries[k];
+            if (!covers(proxies[index], cx, cy)) continue;
+            limit = std::min(limit, static_cast<float>(visit(index)));
+        }
+
+        if (tMaxX < tMaxY) {
+            tCell = tMaxX;
+            tMaxX += tDeltaX;
+            cx += stepX;
+        } else {
+            tCell = tMaxY;
+            tMaxY += tDeltaY;
+            cy += stepY;
+        }
+    }
+}
+
+template<class Visit>
+void SpatialGrid::findPairs(Visit&& visit) const {
+    const int count = static_cast<int>(proxies.size());
+
+    // Binned vs binned: each pair is reported from the first cell both cover
+    for (int a = 0; a < count; a++) {
+        const Proxy& pa = proxies[a];
+        if (pa.large) continue;
+        for (int cy = pa.y0; cy <= pa.y1; cy++) {
+            for (int cx = pa.x0; cx <= pa.x1; cx++) {
+                unsigned bucket = bucketOf(cx, cy);
+                for (int k = cellStart[bucket]; k < cellStart[bucket + 1]; k++) {
+                    int b = cellEntries[k];
+                    if (b <= a) continue;
+                    const Proxy& pb = proxies[b];
+                    if ((pa.ghost && pb.ghost) || pa.body == pb.body) continue;
+                    if (!covers(pb, cx, cy)) continue;
+                    if (cx != std::max(pa.x0, pb.x0) || cy != std::max(pa.y0, pb.y0)) continue;
+                    if (canCollide(pa, pb) && pa.bounds.overlaps(pb.bounds)) visit(a, b);
+                }
+            }
+        }
+    }
+
+    // Large proxies against everything else
+    for (int l : largeProxies) {
+        const Proxy& pl = proxies[l];
+        for (int b = 0; b < count; b++) {
+            if (b == l || (proxies[b].large && b < l)) continue;
+            if ((pl.ghost && proxies[b].ghost) || pl.body == proxies[b].body) continue;
+            if (!canCollide(pl, proxies[b])) continue;
+            if (pl.bounds.overlaps(proxies[b].bounds)) visit(std::min(l, b), std::max(l, b));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef STATEEXPORT_H
+#define STATEEXPORT_H
+
+#include "RigidBody.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ------------------ Shared memory layout (version 1) ------------------
+// One POSIX shared-memory object, native byte order (little-endian on every
+// platform we ship), everything 64-byte aligned:
+//
+//   offset 0                          SharedStateHeader (64 bytes)
+//   offset 64                         slot 0
+//   offset 64 + slotBytes             slot 1
+//
+// Each slot is a SharedStateSlot (64 bytes) followed by eight arrays of
+// `capacity` 4-byte elements, in this order:
+//
+//   0 id        uint32   RigidBody::getId()
+//   1 flags     uint32   bit 0 = static
+//   2 posX      float32  meters
+//   3 posY      float32
+//   4 velX      float32  meters per second
+//   5 velY      float32
+//   6 angle     float32  radians
+//   7 angularV  float32  radians per second
+//
+// Array k of slot s starts at 64 + s * slotBytes + 64 + k * capacity * 4.
+// Only the first `count` entries of a slot are valid.
+//
+// Frames are double buffered. The writer fills the slot the newest frame is
+// NOT in, then bumps epoch, so the newest frame is always in slot epoch & 1
+// and stays untouched for a whole step after it is published. Each slot also
+// has its own seqlock: sequence is odd while the writer is in it. To read:
+//   1. e = epoch; slot = e & 1; s1 = slot.sequence (retry if odd)
+//   2. use the arrays in place
+//   3. s2 = slot.sequence; the frame was consistent if s1 == s2
+// Readers never write to the region and never block the simulation.
+//
+// From Python (the arrays are views, nothing is copied):
+//   buf = mmap.mmap(os.open("/dev/shm" + name, os.O_RDONLY), 0, prot=mmap.PROT_READ)
+//   cap = int(np.frombuffer(buf, np.uint32, 1, 8)[0]); slot_bytes = 64 + 8 * cap * 4
+//   base = 64 + (int(np.frombuffer(buf, np.uint64, 1, 24)[0]) & 1) * slot_bytes
+//   pos_x = np.frombuffer(buf, np.float32, cap, base + 64 + 2 * cap * 4)
+// (macOS keeps shared memory out of the file system; map it with shm_open there.)
+
+struct SharedStateHeader {
+    char magic[4];                  // "PHSX"
+    uint32_t version;               // 1
+    uint32_t capacity;              // Entries per array, a multiple of 16
+    uint32_t arrayCount;            // 8
+    uint64_t slotBytes;             // 64 + arrayCount * capacity * 4
+    std::atomic<uint64_t> epoch;    // Frames published so far; newest is in slot epoch & 1
+    uint8_t reserved[32];
+};
+
+struct SharedStateSlot {
+    std::atomic<uint64_t> sequence; // Odd while being written
+    uint64_t frame;                 // Physics step that produced this frame
+    double time;                    // Simulated seconds at the end of that step
+    uint32_t count;                 // Valid entries in each array
+    uint32_t dropped;               // Bodies left out because capacity was too small
+    uint8_t reserved[32];
+};
+
+static_assert(sizeof(SharedStateHeader) == 64, "shared state header must stay 64 bytes");
+static_assert(sizeof(SharedStateSlot) == 64, "shared state slot header must stay 64 bytes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory needs lock-free 64-bit atomics");
+
+enum class SharedStateArray : uint32_t {
+    Id,
+    Flags,
+    PosX,
+    PosY,
+    VelX,
+    VelY,
+    Angle,
+    AngularV,
+    Count
+};
+
+// Writer side: owns the shared-memory object and publishes body state into it.
+// Attach one to a Physics with setStateExport() and every step publishes the
+// bodies it was given, or call publish() directly.
+class StateExporter {
+    private:
+        char name[64];
+        int fd = -1;
+        uint8_t* base = nullptr;
+        size_t mappedBytes = 0;
+        double time = 0.0;
+
+        SharedStateHeader* header() const { return reinterpret_cast<SharedStateHeader*>(base); }
+        SharedStateSlot* slot(int index) const;
+
+    public:
+        StateExporter() = default;
+        ~StateExporter();
+        StateExporter(const StateExporter&) = delete;
+        StateExporter& operator=(const StateExporter&) = delete;
+
+        // name is a POSIX shm name like "/physics" (keep it under 31 characters for
+        // macOS). Creates or resizes the object; returns false if it can't be mapped.
+        bool open(const char* shmName, int capacity);
+        // Unmaps and removes the object; readers that still have it mapped keep working
+        void close();
+        bool isOpen() const { return base != nullptr; }
+
+        void publish(const std::vector<RigidBody*>& bodies, uint64_t frame, float dt);
+
+        int getCapacity() const { return base ? static_cast<int>(header()->capacity) : 0; }
+        uint64_t getEpoch() const { return base ? header()->epoch.load(std::memory_order_relaxed) : 0; }
+};
+
+// Reader side for C++ consumers; maps the object read-only and hands out
+// pointers straight into it
+class StateReader {
+    private:
+        int fd = -1;
+        const uint8_t* base = nullptr;
+        size_t mappedBytes = 0;
+
+        const SharedStateHeader* header() const { return reinterpret_cast<const SharedStateHeader*>(base); }
+
+    public:
+        StateReader() = default;
+        ~StateReader();
+        StateReader(const StateReader&) = delete;
+        StateReader& operator=(const StateReader&) = delete;
+
+        bool open(const char* shmName);
+        void close();
+        bool isOpen() const { return base != nullptr; }
+
+        // Starts reading the newest frame. Returns null while the region is being
+        // set up (no frame yet) or if the writer is in the slot; try again then.
+        const SharedStateSlot* beginRead(uint64_t& sequence) const;
+        // True if nothing was written to the slot since beginRead
+        bool endRead(const SharedStateSlot* slot, uint64_t sequence) const;
+
+        template<typename T>
+        const T* array(const SharedStateSlot* slot, SharedStateArray which) const {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(slot) + sizeof(SharedStateSlot);
+            return reinterpret_cast<const T*>(data + static_cast<size_t>(which) * header()->capacity * 4);
+        }
+        uint64_t getEpoch() const { return header()->epoch.load(std::memory_order_acquire); }
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fork-join pool for data-parallel loops.
+// parallelFor splits [0, count) into chunks and blocks until all are done;
+// the calling thread works on chunks too. Calls from several threads take
+// turns, and a call made from inside a job (on any pool) runs inline on the
+// calling thread, so queries can use the pool from anywhere.
+class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::mutex submitMutex;  // One job in flight at a time
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        const std::function<void(int, int)>* job = nullptr;
+        int jobCount = 0;
+        int jobGrain = 1;
+        int nextIndex = 0;
+        int activeWorkers = 0;
+        unsigned generation = 0;
+        bool stopping = false;
+
+        void workerLoop();
+        void runChunks(std::unique_lock<std::mutex>& lock);
+
+    public:
+        explicit ThreadPool(int threadCount = 0);  // 0 = hardware concurrency
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+        // fn(begin, end) is called for disjoint ranges covering [0, count)
+        void parallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+
+        // Process-wide pool shared by the engine's parallel paths
+        static ThreadPool& shared();
+};
+
+#endif
@@ -1,32 +1,60 @@
 #ifndef VECTOR2D_H
 #define VECTOR2D_H
 
-class Vector2D {
+#include "Fixed.h"
+#include <cmath>
+#include <type_traits>
+
+// 2D vector templated on the scalar type. Header-only so every operation can
+// be inlined; the engine itself uses the float version, Vector2D.
+template <typename T>
+class Vector2 {
 public:
-    float x;
-    float y;
+    T x;
+    T y;
 
     // Constructors
-    Vector2D();
-    Vector2D(float x, float y);
+    constexpr Vector2() : x(0), y(0) {}
+    constexpr Vector2(T x, T y) : x(x), y(y) {}
+
+    // Converts between scalar types, e.g. Vector2x(someVector2D)
+    template <typename U>
+    constexpr explicit Vector2(const Vector2<U>& v) : x(static_cast<T>(v.x)), y(static_cast<T>(v.y)) {}
 
     // Operator overloads
-    Vector2D operator+(const Vector2D& v) const;
-    Vector2D operator-(const Vector2D& v) const;
-    Vector2D operator*(float scalar) const;
-    Vector2D operator/(float scalar) const;
-    Vector2D& operator+=(const Vector2D& v);
-    Vector2D& operator-=(const Vector2D& v);
-    Vector2D& operator*=(float s);
+    constexpr Vector2 operator+(const Vector2& v) const { return Vector2(x + v.x, y + v.y); }
+    constexpr Vector2 operator-(const Vector2& v) const { return Vector2(x - v.x, y - v.y); }
+    constexpr Vector2 operator*(T scalar) const { return Vector2(x * scalar, y * scalar); }
+    constexpr Vector2 operator/(T scalar) const { return Vector2(x / scalar, y / scalar); }
+    constexpr Vector2& operator+=(const Vector2& v) { x += v.x; y += v.y; return *this; }
+    constexpr Vector2& operator-=(const Vector2& v) { x -= v.x; y -= v.y; return *this; }
+    constexpr Vector2& operator*=(T s) { x *= s; y *= s; return *this; }
 
     // Vector operations
-    float length();
-    Vector2D normalize();
-    float dot(const Vector2D& v) const;
-    Vector2D perpendicular() const;
-    
+    constexpr T lengthSquared() const { return x * x + y * y; }
+    constexpr T length() const {
+        if constexpr (std::is_same<T, Fixed>::value) {
+            return hypot(x, y);  // x * x would saturate past ~181
+        } else {
+            using std::sqrt;
+            return sqrt(x * x + y * y);
+        }
+    }
+    Vector2 normalize() const {
+        T len = length();
+        return Vector2(x / len, y / len);
+    }
+    constexpr T dot(const Vector2& v) const { return (x * v.x + y * v.y); }
+    constexpr Vector2 perpendicular() const { return Vector2(-y, x); }
+
     // Static methods
-    static float distance(const Vector2D& a, const Vector2D& b);
+    static T distance(const Vector2& a, const Vector2& b) { return (a - b).length(); }
 };
 
-#endif
\ No newline at end of file
+using Vector2D = Vector2<float>;   // Throughput (the engine's default)
+using Vector2d = Vector2<double>;  // Large worlds, long horizons
+using Vector2x = Vector2<Fixed>;   // Bit-exact lockstep
+
+static_assert(Vector2x(Fixed(200), Fixed(0)).length() == Fixed(200), "Fixed lengths must hold at world scale");
+
+#endif
@@ -4,14 +4,19 @@
 #include "headers/RectangleCollider.h"
 #include <iostream>
 #include "Physics.h"
+#include "SceneTemplate.h"
+#include "SceneFile.h"
 #include <vector>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 
 // ------------------ Window Setup ------------------
 const int WIDTH = 800;
 const int HEIGHT = 600;
-const float PIXELS_PER_METER = 50.0f;  // Scale factor: 50 pixels = 1 meter
 
 void initOpenGL() {
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f); // dark gray background
@@ -21,8 +26,76 @@ void initOpenGL() {
     glMatrixMode(GL_MODELVIEW);
 }
 
+// ------------------ Command line ------------------
+static int usage() {
+    std::cerr << "Usage: physics_engine [scene]                     open the viewer (default scenes/cup.scene)\n"
+                 "       physics_engine --bench <steps> <scene>     step headless and print timings\n"
+                 "       physics_engine --compile <scene> <out>     write the compiled (.scnb) form\n";
+    return 1;
+}
+
+// Runs the scene without a window; this is the benchmark entry point
+static int runBench(SceneFile& sceneFile, int steps) {
+    const SceneSettings& settings = sceneFile.getSettings();
+    Physics physics(settings.width, settings.height, settings.gravity);
+    sceneFile.configure(physics);
+
+    auto buildStart = std::chrono::steady_clock::now();
+    SceneTemplate scene;
+    if (!sceneFile.build(scene)) return 1;
+    scene.compile();
+    std::vector<RigidBody> bodies;
+    scene.instantiate(bodies, settings.hasSeed ? settings.seed : 1);
+    std::vector<RigidBody*> allBodies;
+    allBodies.reserve(bodies.size());
+    for (auto& body : bodies) {
+        allBodies.push_back(&body);
+    }
+    auto stepStart = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < steps; i++) {
+        physics.step(allBodies, settings.timestep);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double buildMs = std::chrono::duration<double, std::milli>(stepStart - buildStart).count();
+    double stepMs = std::chrono::duration<double, std::milli>(end - stepStart).count();
+    std::cout << bodies.size() << " bodies, build " << buildMs << " ms, " << steps << " steps in "
+              << stepMs << " ms (" << (steps > 0 ? stepMs / steps : 0.0) << " ms/step)\n";
+    return 0;
+}
+
 // ------------------ Main ------------------
-int main() {
+int main(int argc, char** argv) {
+    // ------------------ Scene file ------------------
+    const char* scenePath = "scenes/cup.scene";
+    int benchSteps = -1;
+    if (argc >= 2 && std::strcmp(argv[1], "--compile") == 0) {
+        if (argc != 4) return usage();
+        SceneFile sceneFile;
+        if (!sceneFile.load(argv[2]) || !sceneFile.saveCompiled(argv[3])) return 1;
+        std::cout << argv[3] << ": " << sceneFile.getBodyCount() << " bodies\n";
+        return 0;
+    }
+    if (argc >= 2 && std::strcmp(argv[1], "--bench") == 0) {
+        if (argc != 4 || (benchSteps = std::atoi(argv[2])) < 0) return usage();
+        scenePath = argv[3];
+    } else if (argc == 2 && argv[1][0] != '-') {
+        scenePath = argv[1];
+    } else if (argc != 1) {
+        return usage();
+    }
+
+    auto loadStart = std::chrono::steady_clock::now();
+    SceneFile sceneFile;  // Owns the colliders, so it outlives every body
+    if (!sceneFile.load(scenePath)) return 1;
+    if (benchSteps >= 0) {
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << scenePath << ": loaded in " << loadMs << " ms\n";
+        return runBench(sceneFile, benchSteps);
+    }
+    const SceneSettings& settings = sceneFile.getSettings();
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW\n";
         return -1;
@@ -40,85 +113,36 @@ int main() {
 
     // ------------------ Physics setup ------------------
 
-    RigidBody::pixelsPerMeter = PIXELS_PER_METER;
-    
-    float worldWidthMeters = WIDTH / PIXELS_PER_METER;   // 16 meters
-    float worldHeightMeters = HEIGHT / PIXELS_PER_METER; // 12 meters
-    
-    Physics physics(worldWidthMeters, worldHeightMeters);
-    
-    // ------------------ Create Cup Structure ------------------
-    std::vector<RigidBody> staticObjects;
-    
-    // Cup position and dimensions
-    float cupBottomY = -4.0f;
-    float cupX = 2.0f;
-    float cupWidth = 3.0f;
-    float cupWallHeight = 2.5f;
-    float wallThickness = 0.2f;
-    
-    // Cup bottom
-    RigidBody cupBottom(Vector2D(cupX, cupBottomY), 1.0f, true);
-    cupBottom.setCollider(new RectangleCollider(cupWidth, wallThickness));
-    cupBottom.setRestitution(0.3f);
-    staticObjects.push_back(cupBottom);
-    
-    // Cup left wall
-    RigidBody cupLeftWall(Vector2D(cupX - cupWidth/2 + wallThickness/2, cupBottomY + cupWallHeight/2), 1.0f, true);
-    cupLeftWall.setCollider(new RectangleCollider(wallThickness, cupWallHeight));
-    cupLeftWall.setRestitution(0.3f);
-    staticObjects.push_back(cupLeftWall);
-    
-    // Cup right wall
-    RigidBody cupRightWall(Vector2D(cupX + cupWidth/2 - wallThickness/2, cupBottomY + cupWallHeight/2), 1.0f, true);
-    cupRightWall.setCollider(new RectangleCollider(wallThickness, cupWallHeight));
-    cupRightWall.setRestitution(0.3f);
-    staticObjects.push_back(cupRightWall);
-    
-    // ------------------ Create Ramp ------------------
-    float rampLength = 8.0f;
-    float rampWidth = 0.3f;
-    float rampAngle = -0.4f;  // Radians (about -23 degrees)
-    
-    // Position ramp to lead into the cup
-    float rampX = -4.0f;
-    float rampY = 0.0f;
-    
-    RigidBody ramp(Vector2D(rampX, rampY),1.0f, true);
-    ramp.setCollider(new RectangleCollider(rampLength, rampWidth));
-    ramp.setAngle(rampAngle);
-    ramp.setRestitution(0.4f);
-    staticObjects.push_back(ramp);
-    
-    // ------------------ Create Balls ------------------
-    std::vector<RigidBody> balls;
+    // Fit the whole world into the window (the default scene is 16 x 12 meters)
+    RigidBody::pixelsPerMeter = std::min(WIDTH / settings.width, HEIGHT / settings.height);
+
+    Physics physics(settings.width, settings.height, settings.gravity);
+    sceneFile.configure(physics);
     
-    const float ballRadius = 0.02f;
-    const float ballMass = 0.001f;  // Small consistent mass
-    int numBalls = 50;  // Start with 50 to test (1000 might be slow!)
-    float startX = -6.5f;
-    float startY = 1.5f;
-    float rangeX = 1.0f;  // Spread 1 meter horizontally
-    float rangeY = 1.0f;  // Spread 1 meter vertically
+    // ------------------ Scene template ------------------
+    // The scene is described once; every episode is a cheap reset of the template.
+    SceneTemplate scene;
+    if (!sceneFile.build(scene)) {
+        glfwTerminate();
+        return 1;
+    }
+    scene.compile();
     
-    // Seed the random number generator
-    srand(time(NULL));
+    std::vector<RigidBody> bodies;
+    uint64_t episodeSeed = settings.hasSeed ? settings.seed : static_cast<uint64_t>(time(NULL));
+    scene.instantiate(bodies, episodeSeed);
     
-    for(int i = 0; i < numBalls; i++) {
-        // Generate random offsets (rand() / (float)RAND_MAX gives 0.0 to 1.0)
-        float randomX = startX + rangeX * (rand() / (float)RAND_MAX);
-        float randomY = startY + rangeY * (rand() / (float)RAND_MAX);
-        
-        RigidBody ball(Vector2D(randomX, randomY), ballMass, false);
-        ball.setCollider(new CircleCollider(ballRadius));
-        ball.setRestitution(0.6f);
-        balls.push_back(ball);
+    // The body array is never reallocated after this, so the pointers stay valid across resets
+    std::vector<RigidBody*> allBodies;
+    for (auto& body : bodies) {
+        allBodies.push_back(&body);
     }
     
-    // NOW start the game loop (OUTSIDE the ball creation loop)
-    const float FIXED_TIMESTEP = 1.0f / 60.0f; // 60 FPS
+    // NOW start the game loop
+    const float FIXED_TIMESTEP = settings.timestep;
     float accumulator = 0.0f;
     double lastTime = glfwGetTime();
+    bool resetHeld = false;
     
     // ------------------ Main loop ------------------
     while (!glfwWindowShouldClose(window)) {
@@ -128,24 +152,8 @@ int main() {
         accumulator += deltaTime;
         
         while (accumulator >= FIXED_TIMESTEP) {
-            // Apply gravity and physics to all balls
-            for (auto& ball : balls) {
-                physics.applyGravity(ball);
-                ball.update(FIXED_TIMESTEP);
-                physics.checkWallCollisions(ball);  // Bounce off walls
-            }
-            
-            // Collect all bodies for collision detection (balls + static objects)
-            std::vector<RigidBody*> allBodies;
-            for (auto& ball : balls) {
-                allBodies.push_back(&ball);
-            }
-            for (auto& obj : staticObjects) {
-                allBodies.push_back(&obj);
-            }
-            
-            physics.checkBodyCollisions(allBodies);
-            
+            // Gravity, integration, walls and collisions for balls + static objects
+            physics.step(allBodies, FIXED_TIMESTEP);
             accumulator -= FIXED_TIMESTEP;
         }
 
@@ -153,18 +161,21 @@ int main() {
         glClear(GL_COLOR_BUFFER_BIT);
         glLoadIdentity();
 
-        // Draw static objects (cup and ramp)
-        for (auto& obj : staticObjects) {
-            obj.draw();
-        }
-
-        // Draw all balls
-        for (auto& ball : balls) {
-            ball.draw();
+        // Draw every body in the scene
+        for (auto& body : bodies) {
+            body.draw();
         }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
+        
+        // R starts a new episode from the template, once per press
+        bool resetDown = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        if (resetDown && !resetHeld) {
+            scene.reset(bodies, ++episodeSeed);
+            physics.clearContacts();  // Cached pairs belong to the old episode
+        }
+        resetHeld = resetDown;
     }
 
     glfwTerminate();
@@ -0,0 +1,382 @@
+#include "ChunkedWorld.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const uint32_t chunkMagic = 0x314B4843;  // "CHK1"
+
+ChunkedWorld::ChunkedWorld(float chunkSize, const Vector2D& gravity)
+    : chunkSize(chunkSize),
+      activeRadius(2.0 * chunkSize),
+      unloadRadius(4.0 * chunkSize),
+      rebaseDistance(4.0 * chunkSize),
+      physics(chunkSize, chunkSize, gravity)
+{
+    // No world bounds; chunks are the only limit
+    physics.setBoundary(BoundarySide::Left, BoundaryMode::Open);
+    physics.setBoundary(BoundarySide::Right, BoundaryMode::Open);
+    physics.setBoundary(BoundarySide::Bottom, BoundaryMode::Open);
+    physics.setBoundary(BoundarySide::Top, BoundaryMode::Open);
+}
+
+// ------------------ Coordinates ------------------
+
+uint64_t ChunkedWorld::chunkKey(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+int32_t ChunkedWorld::chunkX(double worldX) const { return static_cast<int32_t>(std::floor(worldX / chunkSize)); }
+int32_t ChunkedWorld::chunkY(double worldY) const { return static_cast<int32_t>(std::floor(worldY / chunkSize)); }
+
+Vector2d ChunkedWorld::chunkCorner(int32_t x, int32_t y) const {
+    return Vector2d(static_cast<double>(x) * chunkSize, static_cast<double>(y) * chunkSize);
+}
+
+Vector2d ChunkedWorld::toWorld(const Vector2D& local) const { return origin + Vector2d(local); }
+Vector2D ChunkedWorld::toLocal(const Vector2d& world) const { return Vector2D(world - origin); }
+
+// ------------------ Serialization helpers ------------------
+
+template <typename T>
+static void writeValue(std::vector<uint8_t>& out, const T& value) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+static bool readValue(const std::vector<uint8_t>& in, size_t& at, T& value) {
+    if (at + sizeof(T) > in.size()) return false;
+    std::memcpy(&value, in.data() + at, sizeof(T));
+    at += sizeof(T);
+    return true;
+}
+
+// Layout: magic, chunk x, chunk y, body count, then per body a BodyState with the
+// position relative to the chunk corner, mass, restitution, friction, static flag
+// and collider index (-1 for none). Native endianness.
+static const size_t countOffset = 12;
+
+static void writeBody(std::vector<uint8_t>& out, const BodyState& state, const RigidBody& body, int collider) {
+    writeValue(out, state);
+    writeValue(out, body.getMass());
+    writeValue(out, body.getRestitution());
+    writeValue(out, body.getFriction());
+    writeValue(out, static_cast<uint8_t>(body.isStaticBody() ? 1 : 0));
+    writeValue(out, static_cast<int32_t>(collider));
+}
+
+// ------------------ Setup ------------------
+
+int ChunkedWorld::colliderIndex(Collider* collider) const {
+    for (size_t i = 0; i < colliders.size(); i++) {
+        if (colliders[i] == collider) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int ChunkedWorld::registerCollider(Collider* collider) {
+    int index = colliderIndex(collider);
+    if (index >= 0) return index;
+    colliders.push_back(collider);
+    return static_cast<int>(colliders.size()) - 1;
+}
+
+RigidBody* ChunkedWorld::addBody(const RigidBody& prototype, const Vector2d& worldPos) {
+    int collider = prototype.getCollider() ? registerCollider(prototype.getCollider()) : -1;
+    int32_t x = chunkX(worldPos.x);
+    int32_t y = chunkY(worldPos.y);
+    uint64_t key = chunkKey(x, y);
+
+    // Far from the origin a float local position would already be imprecise,
+    // so unloaded chunks out there get the body appended to their stored bytes
+    if (!chunks.count(key) && (worldPos - origin).length() > rebaseDistance + unloadRadius) {
+        std::vector<uint8_t>& data = storedChunks[key];
+        if (data.empty()) {
+            writeValue(data, chunkMagic);
+            writeValue(data, x);
+            writeValue(data, y);
+            writeValue(data, static_cast<uint32_t>(0));
+        }
+        BodyState state = prototype.getState();
+        state.position = Vector2D(worldPos - chunkCorner(x, y));
+        writeBody(data, state, prototype, collider);
+
+        uint32_t count;
+        std::memcpy(&count, data.data() + countOffset, sizeof(count));
+        count++;
+        std::memcpy(data.data() + countOffset, &count, sizeof(count));
+        return nullptr;
+    }
+
+    WorldChunk& chunk = chunkFor(x, y);
+    chunk.bodies.push_back(std::unique_ptr<RigidBody>(new RigidBody(prototype)));
+    RigidBody* body = chunk.bodies.back().get();
+    body->assignNewId();
+    body->setPosition(toLocal(worldPos));
+    return body;
+}
+
+int ChunkedWorld::addPointOfInterest(const Vector2d& worldPos) {
+    pointsOfInterest.push_back(worldPos);
+    return static_cast<int>(pointsOfInterest.size()) - 1;
+}
+
+void ChunkedWorld::setRadii(double active, double unload) {
+    activeRadius = active;
+    // Sleeping chunks must reach past the border ring
+    unloadRadius = std::max(unload, active + chunkSize);
+}
+
+// ------------------ Chunks ------------------
+
+WorldChunk& ChunkedWorld::chunkFor(int32_t x, int32_t y) {
+    uint64_t key = chunkKey(x, y);
+    auto it = chunks.find(key);
+    if (it != chunks.end()) return it->second;
+
+    auto stored = storedChunks.find(key);
+    if (stored != storedChunks.end()) {
+        std::vector<uint8_t> data;
+        data.swap(stored->second);
+        loadChunk(x, y, data);
+        storedChunks.erase(key);  // Already gone if it loaded; unreadable data is dropped
+    }
+
+    WorldChunk& chunk = chunks[key];
+    chunk.x = x;
+    chunk.y = y;
+    return chunk;
+}
+
+const WorldChunk* ChunkedWorld::findChunk(int32_t x, int32_t y) const {
+    auto it = chunks.find(chunkKey(x, y));
+    return it == chunks.end() ? nullptr : &it->second;
+}
+
+bool ChunkedWorld::isChunkStored(int32_t x, int32_t y) const {
+    return storedChunks.count(chunkKey(x, y)) > 0;
+}
+
+// ------------------ Serialization ------------------
+
+bool ChunkedWorld::serializeChunk(int32_t x, int32_t y, std::vector<uint8_t>& out) const {
+    out.clear();
+    const WorldChunk* chunk = findChunk(x, y);
+    if (!chunk) {
+        auto stored = storedChunks.find(chunkKey(x, y));
+        if (stored == storedChunks.end()) return false;
+        out = stored->second;
+        return true;
+    }
+
+    Vector2d corner = chunkCorner(x, y);
+    writeValue(out, chunkMagic);
+    writeValue(out, x);
+    writeValue(out, y);
+    writeValue(out, static_cast<uint32_t>(chunk->bodies.size()));
+    for (const auto& body : chunk->bodies) {
+        BodyState state = body->getState();
+        state.position = Vector2D(toWorld(state.position) - corner);
+        writeBody(out, state, *body, colliderIndex(body->getCollider()));
+    }
+    return true;
+}
+
+bool ChunkedWorld::loadChunk(int32_t x, int32_t y, const std::vector<uint8_t>& data) {
+    uint64_t key = chunkKey(x, y);
+    if (chunks.count(key)) return false;
+
+    size_t at = 0;
+    uint32_t magic = 0, count = 0;
+    int32_t savedX = 0, savedY = 0;
+    if (!readValue(data, at, magic) || magic != chunkMagic) return false;
+    if (!readValue(data, at, savedX) || !readValue(data, at, savedY) || !readValue(data, at, count)) return false;
+
+    // Positions are chunk-relative, so a chunk can be loaded at other coordinates
+    Vector2d corner = chunkCorner(x, y);
+    std::vector<std::unique_ptr<RigidBody>> bodies;
+    bodies.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        BodyState state;
+        float mass, restitution, friction;
+        uint8_t isStatic;
+        int32_t collider;
+        if (!readValue(data, at, state) || !readValue(data, at, mass) || !readValue(data, at, restitution) ||
+            !readValue(data, at, friction) || !readValue(data, at, isStatic) || !readValue(data, at, collider)) {
+            return false;
+        }
+
+        std::unique_ptr<RigidBody> body(new RigidBody(Vector2D(), mass, isStatic != 0));
+        body->setRestitution(restitution);
+        body->setFriction(friction);
+        if (collider >= 0 && collider < static_cast<int32_t>(colliders.size())) {
+            body->setCollider(colliders[collider]);
+        }
+        state.position = toLocal(corner + Vector2d(state.position));
+        body->setState(state);
+        bodies.push_back(std::move(body));
+    }
+
+    WorldChunk& chunk = chunks[key];
+    chunk.x = x;
+    chunk.y = y;
+    chunk.state = ChunkState::Sleeping;
+    chunk.bodies = std::move(bodies);
+    storedChunks.erase(key);
+    return true;
+}
+
+bool ChunkedWorld::unloadChunk(int32_t x, int32_t y) {
+    uint64_t key = chunkKey(x, y);
+    auto it = chunks.find(key);
+    if (it == chunks.end()) return false;
+
+    // Empty chunks are just dropped
+    if (!it->second.bodies.empty()) {
+        for (const auto& body : it->second.bodies) {
+            if (body->getCollider()) registerCollider(body->getCollider());
+        }
+        serializeChunk(x, y, storedChunks[key]);
+    }
+
+    // The physics and the last step's body list may still point at these bodies
+    unloading.clear();
+    for (const auto& body : it->second.bodies) unloading.push_back(body.get());
+    physics.forgetBodies(unloading);
+    std::sort(unloading.begin(), unloading.end());
+    activeBodies.erase(std::remove_if(activeBodies.begin(), activeBodies.end(), [&](RigidBody* body) {
+        return std::binary_search(unloading.begin(), unloading.end(), body);
+    }), activeBodies.end());
+    chunks.erase(it);
+    return true;
+}
+
+// ------------------ Step ------------------
+
+void ChunkedWorld::rebaseIfNeeded() {
+    if (pointsOfInterest.empty()) return;
+    const Vector2d& focus = pointsOfInterest[0];
+    if ((focus - origin).length() <= rebaseDistance) return;
+
+    // Snap to a chunk corner and move every loaded body, going through doubles
+    Vector2d newOrigin = chunkCorner(chunkX(focus.x), chunkY(focus.y));
+    for (auto& entry : chunks) {
+        for (auto& body : entry.second.bodies) {
+            Vector2d world = toWorld(body->getPosition());
+            body->setPosition(Vector2D(world - newOrigin));
+        }
+    }
+    origin = newOrigin;
+}
+
+// Unloads chunks far from every point of interest, rebases, then loads and
+// labels the chunks that are near one
+void ChunkedWorld::updateChunkStates() {
+    // Without points of interest nothing changes
+    if (pointsOfInterest.empty()) return;
+
+    // Every chunk within unloadRadius of some point, with its most active state
+    wanted.clear();
+    for (const Vector2d& p : pointsOfInterest) {
+        int32_t x0 = chunkX(p.x - unloadRadius), x1 = chunkX(p.x + unloadRadius);
+        int32_t y0 = chunkY(p.y - unloadRadius), y1 = chunkY(p.y + unloadRadius);
+        for (int32_t cy = y0; cy <= y1; cy++) {
+            for (int32_t cx = x0; cx <= x1; cx++) {
+                Vector2d corner = chunkCorner(cx, cy);
+                double dx = std::max(0.0, std::max(corner.x - p.x, p.x - (corner.x + chunkSize)));
+                double dy = std::max(0.0, std::max(corner.y - p.y, p.y - (corner.y + chunkSize)));
+                double distance = std::sqrt(dx * dx + dy * dy);
+                if (distance > unloadRadius) continue;
+
+                ChunkState state = ChunkState::Sleeping;
+                if (distance <= activeRadius) state = ChunkState::Active;
+                else if (distance <= activeRadius + chunkSize) state = ChunkState::Border;
+
+                auto result = wanted.emplace(chunkKey(cx, cy), state);
+                if (static_cast<int>(state) > static_cast<int>(result.first->second)) {
+                    result.first->second = state;
+                }
+            }
+        }
+    }
+
+    // Stream out chunks nobody is near
+    std::vector<std::pair<int32_t, int32_t>> unwanted;
+    for (const auto& entry : chunks) {
+        if (!wanted.count(entry.first)) unwanted.push_back({entry.second.x, entry.second.y});
+    }
+    for (const auto& c : unwanted) unloadChunk(c.first, c.second);
+
+    // Rebase between the two, so nothing far away is ever held in float
+    // coordinates around an origin it is not near
+    rebaseIfNeeded();
+
+    // Stream in stored chunks that are wanted again, and label everything
+    for (const auto& entry : wanted) {
+        auto it = chunks.find(entry.first);
+        if (it == chunks.end()) {
+            if (!storedChunks.count(entry.first)) continue;  // Nothing there
+            int32_t x = static_cast<int32_t>(entry.first >> 32);
+            int32_t y = static_cast<int32_t>(entry.first & 0xFFFFFFFFu);
+            chunkFor(x, y).state = entry.second;
+        } else {
+            it->second.state = entry.second;
+        }
+    }
+}
+
+void ChunkedWorld::migrateBodies() {
+    // Collect first: moving into a new chunk can rehash the map
+    std::vector<std::unique_ptr<RigidBody>> moving;
+    for (auto& entry : chunks) {
+        WorldChunk& chunk = entry.second;
+        if (chunk.state != ChunkState::Active) continue;
+
+        auto& bodies = chunk.bodies;
+        for (size_t i = 0; i < bodies.size();) {
+            Vector2d world = toWorld(bodies[i]->getPosition());
+            if (chunkX(world.x) == chunk.x && chunkY(world.y) == chunk.y) {
+                i++;
+                continue;
+            }
+            moving.push_back(std::move(bodies[i]));
+            bodies[i] = std::move(bodies.back());
+            bodies.pop_back();
+        }
+    }
+
+    for (auto& body : moving) {
+        Vector2d world = toWorld(body->getPosition());
+        chunkFor(chunkX(world.x), chunkY(world.y)).bodies.push_back(std::move(body));
+    }
+}
+
+void ChunkedWorld::step(float dt) {
+    updateChunkStates();
+
+    // Active chunks simulate; border chunks join as temporarily static obstacles
+    activeBodies.clear();
+    pinnedBodies.clear();
+    stepList.clear();
+    for (auto& entry : chunks) {
+        WorldChunk& chunk = entry.second;
+        if (chunk.state == ChunkState::Active) {
+            for (auto& body : chunk.bodies) activeBodies.push_back(body.get());
+        } else if (chunk.state == ChunkState::Border) {
+            for (auto& body : chunk.bodies) {
+                if (!body->isStaticBody()) {
+                    body->setStatic(true);
+                    pinnedBodies.push_back(body.get());
+                }
+                stepList.push_back(body.get());
+            }
+        }
+    }
+    stepList.insert(stepList.end(), activeBodies.begin(), activeBodies.end());
+
+    physics.step(stepList, dt);
+
+    for (RigidBody* body : pinnedBodies) body->setStatic(false);
+    migrateBodies();
+}
@@ -0,0 +1,255 @@
+#include "Collider.h"
+#include "Query.h"
+#include "RigidBody.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// ------------------ Helpers ------------------
+
+static Vector2D rotate(const Vector2D& v, float c, float s) {
+    return Vector2D(v.x * c - v.y * s, v.x * s + v.y * c);
+}
+
+static Vector2D unrotate(const Vector2D& v, float c, float s) {
+    return Vector2D(v.x * c + v.y * s, -v.x * s + v.y * c);
+}
+
+// Ray against a circle. Starting inside counts as a hit at distance 0.
+static bool rayCircle(const Vector2D& origin, const Vector2D& dir, const Vector2D& center, float radius,
+                      float maxDistance, float& distance, Vector2D& normal) {
+    Vector2D m = origin - center;
+    float c = m.dot(m) - radius * radius;
+    if (c <= 0.0f) {
+        distance = 0.0f;
+        normal = dir * -1.0f;
+        return true;
+    }
+    float b = m.dot(dir);
+    if (b > 0.0f) return false;  // Outside and pointing away
+    float disc = b * b - c;
+    if (disc < 0.0f) return false;
+
+    float t = -b - std::sqrt(disc);
+    if (t > maxDistance) return false;
+    distance = t;
+    Vector2D hit = m + dir * t;
+    normal = hit / radius;
+    return true;
+}
+
+// Ray against an axis-aligned box centered at the origin (local space)
+static bool rayLocalBox(const Vector2D& origin, const Vector2D& dir, float hw, float hh,
+                        float maxDistance, float& distance, Vector2D& normal) {
+    float tMin = 0.0f;
+    float tMax = maxDistance;
+    Vector2D enterNormal = dir * -1.0f;  // Used when the ray starts inside
+
+    const float o[2] = {origin.x, origin.y};
+    const float d[2] = {dir.x, dir.y};
+    const float h[2] = {hw, hh};
+    for (int axis = 0; axis < 2; axis++) {
+        if (std::abs(d[axis]) < 1e-12f) {
+            if (std::abs(o[axis]) > h[axis]) return false;
+            continue;
+        }
+        float inv = 1.0f / d[axis];
+        float t0 = (-h[axis] - o[axis]) * inv;
+        float t1 = (h[axis] - o[axis]) * inv;
+        float sign = -1.0f;  // Entering through the negative face
+        if (t0 > t1) {
+            std::swap(t0, t1);
+            sign = 1.0f;
+        }
+        if (t0 > tMin) {
+            tMin = t0;
+            enterNormal = axis == 0 ? Vector2D(sign, 0.0f) : Vector2D(0.0f, sign);
+        }
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax) return false;
+    }
+    distance = tMin;
+    normal = enterNormal;
+    return true;
+}
+
+// Ray against a box inflated by radius (the Minkowski sum of a box and a circle), in local space
+static bool rayLocalRoundedBox(const Vector2D& origin, const Vector2D& dir, float hw, float hh, float radius,
+                               float maxDistance, float& distance, Vector2D& normal) {
+    bool hit = false;
+    float best = maxDistance;
+    float t;
+    Vector2D n;
+
+    if (rayLocalBox(origin, dir, hw + radius, hh, best, t, n)) { best = t; normal = n; hit = true; }
+    if (rayLocalBox(origin, dir, hw, hh + radius, best, t, n)) { best = t; normal = n; hit = true; }
+    const Vector2D corners[4] = {Vector2D(hw, hh), Vector2D(-hw, hh), Vector2D(-hw, -hh), Vector2D(hw, -hh)};
+    for (const Vector2D& corner : corners) {
+        if (rayCircle(origin, dir, corner, radius, best, t, n)) { best = t; normal = n; hit = true; }
+    }
+    if (hit) distance = best;
+    return hit;
+}
+
+// Half extents of a rectangle projected onto an axis
+static float projectedRadius(const Vector2D& axis, const Vector2D& ux, const Vector2D& uy, float hw, float hh) {
+    return hw * std::abs(axis.dot(ux)) + hh * std::abs(axis.dot(uy));
+}
+
+// Ray against a half-plane pushed out by inflate. Starting behind it is a hit at 0.
+static bool rayPlane(const Vector2D& origin, const Vector2D& dir, const Vector2D& planePoint,
+                     const Vector2D& planeNormal, float inflate, float maxDistance,
+                     float& distance, Vector2D& normal) {
+    float height = (origin - planePoint).dot(planeNormal) - inflate;
+    normal = planeNormal;
+    if (height <= 0.0f) {
+        distance = 0.0f;
+        return true;
+    }
+    float approach = dir.dot(planeNormal);
+    if (approach >= 0.0f) return false;
+    distance = -height / approach;
+    return distance <= maxDistance;
+}
+
+// ------------------ Per-shape queries ------------------
+
+bool raycastBody(const RigidBody& body, const Vector2D& origin, const Vector2D& dir,
+                 float maxDistance, float& distance, Vector2D& normal) {
+    Collider* collider = body.getCollider();
+    if (!collider) return false;
+
+    if (collider->getType() == ColliderType::Circle) {
+        return rayCircle(origin, dir, body.getPosition(), collider->getRadius(), maxDistance, distance, normal);
+    }
+    if (collider->getType() == ColliderType::Plane) {
+        return rayPlane(origin, dir, body.getPosition(), collider->getNormal(), 0.0f, maxDistance, distance, normal);
+    }
+
+    // Rectangle: test in the body's local frame and rotate the normal back
+    float c = body.getCosAngle();
+    float s = body.getSinAngle();
+    Vector2D localOrigin = unrotate(origin - body.getPosition(), c, s);
+    Vector2D localDir = unrotate(dir, c, s);
+    Vector2D localNormal;
+    if (!rayLocalBox(localOrigin, localDir, collider->getWidth() / 2.0f, collider->getHeight() / 2.0f,
+                     maxDistance, distance, localNormal)) {
+        return false;
+    }
+    normal = rotate(localNormal, c, s);
+    return true;
+}
+
+bool circleCastBody(const RigidBody& body, const Vector2D& origin, float radius, const Vector2D& dir,
+                    float maxDistance, float& distance, Vector2D& normal) {
+    Collider* collider = body.getCollider();
+    if (!collider) return false;
+
+    if (collider->getType() == ColliderType::Circle) {
+        // Sweeping a circle against a circle is a ray against the summed radius
+        return rayCircle(origin, dir, body.getPosition(), collider->getRadius() + radius,
+                         maxDistance, distance, normal);
+    }
+    if (collider->getType() == ColliderType::Plane) {
+        return rayPlane(origin, dir, body.getPosition(), collider->getNormal(), radius, maxDistance, distance, normal);
+    }
+
+    float c = body.getCosAngle();
+    float s = body.getSinAngle();
+    Vector2D localOrigin = unrotate(origin - body.getPosition(), c, s);
+    Vector2D localDir = unrotate(dir, c, s);
+    Vector2D localNormal;
+    if (!rayLocalRoundedBox(localOrigin, localDir, collider->getWidth() / 2.0f, collider->getHeight() / 2.0f,
+                            radius, maxDistance, distance, localNormal)) {
+        return false;
+    }
+    normal = rotate(localNormal, c, s);
+    return true;
+}
+
+bool boxCastBody(const RigidBody& body, const Vector2D& origin, const Vector2D& halfExtents, float angle,
+                 const Vector2D& dir, float maxDistance, float& distance, Vector2D& normal) {
+    Collider* collider = body.getCollider();
+    if (!collider) return false;
+
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+
+    if (collider->getType() == ColliderType::Plane) {
+        // The box touches the plane when its center is one projected radius away
+        Vector2D n = collider->getNormal();
+        float inflate = projectedRadius(n, Vector2D(c, s), Vector2D(-s, c), halfExtents.x, halfExtents.y);
+        return rayPlane(origin, dir, body.getPosition(), n, inflate, maxDistance, distance, normal);
+    }
+
+    if (collider->getType() == ColliderType::Circle) {
+        // A box moving onto a circle is the circle moving backwards onto the box
+        Vector2D localOrigin = unrotate(body.getPosition() - origin, c, s);
+        Vector2D localDir = unrotate(dir * -1.0f, c, s);
+        Vector2D boxNormal;
+        if (!rayLocalRoundedBox(localOrigin, localDir, halfExtents.x, halfExtents.y, collider->getRadius(),
+                                maxDistance, distance, boxNormal)) {
+            return false;
+        }
+        normal = rotate(boxNormal, c, s) * -1.0f;
+        return true;
+    }
+
+    // Box against rectangle: separating axis test over the time of overlap on each axis
+    float bc = body.getCosAngle();
+    float bs = body.getSinAngle();
+    Vector2D castX(c, s), castY(-s, c);
+    Vector2D bodyX(bc, bs), bodyY(-bs, bc);
+    float bodyHw = collider->getWidth() / 2.0f;
+    float bodyHh = collider->getHeight() / 2.0f;
+    const Vector2D axes[4] = {castX, castY, bodyX, bodyY};
+
+    float tFirst = 0.0f;
+    float tLast = maxDistance;
+    Vector2D firstAxis = dir * -1.0f;
+    Vector2D delta = body.getPosition() - origin;
+    for (const Vector2D& axis : axes) {
+        float gap = delta.dot(axis);
+        float reach = projectedRadius(axis, castX, castY, halfExtents.x, halfExtents.y) +
+                      projectedRadius(axis, bodyX, bodyY, bodyHw, bodyHh);
+        float speed = dir.dot(axis);
+
+        // Caster overlaps the body along this axis while |gap - speed * t| <= reach
+        if (std::abs(speed) < 1e-12f) {
+            if (std::abs(gap) > reach) return false;
+            continue;
+        }
+        float t0 = (gap - reach) / speed;
+        float t1 = (gap + reach) / speed;
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > tFirst) {
+            tFirst = t0;
+            firstAxis = speed > 0.0f ? axis * -1.0f : axis;
+        }
+        tLast = std::min(tLast, t1);
+        if (tFirst > tLast) return false;
+    }
+    distance = tFirst;
+    normal = firstAxis;
+    return true;
+}
+
+bool bodyContainsPoint(const RigidBody& body, const Vector2D& point) {
+    Collider* collider = body.getCollider();
+    if (!collider) return false;
+
+    Vector2D delta = point - body.getPosition();
+    if (collider->getType() == ColliderType::Plane) {
+        return delta.dot(collider->getNormal()) <= 0.0f;
+    }
+    if (collider->getType() == ColliderType::Circle) {
+        float r = collider->getRadius();
+        return delta.dot(delta) <= r * r;
+    }
+
+    float c = body.getCosAngle();
+    float s = body.getSinAngle();
+    Vector2D local = unrotate(delta, c, s);
+    return std::abs(local.x) <= collider->getWidth() / 2.0f &&
+           std::abs(local.y) <= collider->getHeight() / 2.0f;
+}
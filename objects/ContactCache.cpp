@@ -0,0 +1,118 @@
+#include "ContactCache.h"
+#include <algorithm>
+#include <utility>
+
+ContactCache::ContactCache() {
+    slots.assign(64, ContactPair{});
+    mask = slots.size() - 1;
+}
+
+uint64_t ContactCache::makeKey(uint32_t idA, uint32_t idB) {
+    if (idA > idB) std::swap(idA, idB);
+    return (static_cast<uint64_t>(idA) << 32) | idB;
+}
+
+size_t ContactCache::hashKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+}
+
+void ContactCache::grow() {
+    std::vector<ContactPair> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, ContactPair{});
+    mask = slots.size() - 1;
+
+    // Reinsert live pairs with linear probing
+    for (const ContactPair& pair : old) {
+        if (pair.key == 0) continue;
+        size_t slot = hashKey(pair.key) & mask;
+        while (slots[slot].key != 0) slot = (slot + 1) & mask;
+        slots[slot] = pair;
+    }
+}
+
+ContactPair* ContactCache::findOrAdd(RigidBody* a, RigidBody* b, unsigned frame, bool& added) {
+    // Keep the load factor at or below one half
+    if ((count + 1) * 2 > slots.size()) grow();
+
+    if (a->getId() > b->getId()) std::swap(a, b);
+    uint64_t key = makeKey(a->getId(), b->getId());
+    size_t slot = hashKey(key) & mask;
+    while (slots[slot].key != 0) {
+        if (slots[slot].key == key) {
+            // Ids are the identity; refresh the pointers in case the bodies moved
+            slots[slot].bodyA = a;
+            slots[slot].bodyB = b;
+            added = false;
+            return &slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    ContactPair& pair = slots[slot];
+    pair = ContactPair{};
+    pair.key = key;
+    pair.bodyA = a;
+    pair.bodyB = b;
+    pair.firstFrame = frame;
+    pair.lastSeenFrame = frame;
+    count++;
+    added = true;
+    return &pair;
+}
+
+ContactPair* ContactCache::find(uint32_t idA, uint32_t idB) {
+    uint64_t key = makeKey(idA, idB);
+    size_t slot = hashKey(key) & mask;
+    while (slots[slot].key != 0) {
+        if (slots[slot].key == key) return &slots[slot];
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+void ContactCache::insert(const ContactPair& pair) {
+    if ((count + 1) * 2 > slots.size()) grow();
+
+    size_t slot = hashKey(pair.key) & mask;
+    while (slots[slot].key != 0 && slots[slot].key != pair.key) {
+        slot = (slot + 1) & mask;
+    }
+    if (slots[slot].key == 0) count++;
+    slots[slot] = pair;
+}
+
+void ContactCache::eraseSlot(size_t slot) {
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+    while (slots[next].key != 0) {
+        size_t home = hashKey(slots[next].key) & mask;
+        // Move the entry back if its home is not in (hole, next]
+        bool movable = (next > hole) ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots[hole] = ContactPair{};
+    count--;
+}
+
+void ContactCache::clear() {
+    std::fill(slots.begin(), slots.end(), ContactPair{});
+    count = 0;
+}
+
+void ContactCache::setSlots(const std::vector<ContactPair>& saved) {
+    slots = saved;
+    mask = slots.size() - 1;
+    count = 0;
+    for (const ContactPair& pair : slots) {
+        if (pair.key != 0) count++;
+    }
+}
@@ -0,0 +1,424 @@
+#include "DistributedWorld.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+DistributedWorld::DistributedWorld(float width, float height, const Vector2D& grav)
+    : worldWidth(width),
+      worldHeight(height),
+      gravity(grav),
+      haloWidth(0.5f),
+      balanceInterval(30)
+{}
+
+int DistributedWorld::addCollider(Collider* collider) {
+    for (size_t i = 0; i < colliders.size(); i++) {
+        if (colliders[i] == collider) return static_cast<int>(i);
+    }
+    colliders.push_back(collider);
+    return static_cast<int>(colliders.size()) - 1;
+}
+
+void DistributedWorld::addBody(const RigidBody& body) {
+    if (body.isStaticBody()) {
+        staticBodies.push_back(body);
+        return;
+    }
+    DistributedBody record;
+    record.globalId = static_cast<uint32_t>(bodies.size());
+    record.state = body.getState();
+    record.mass = body.getMass();
+    record.restitution = body.getRestitution();
+    record.friction = body.getFriction();
+    record.collider = body.getCollider() ? addCollider(body.getCollider()) : -1;
+    bodies.push_back(record);
+}
+
+// ------------------ Messaging ------------------
+
+// Sends one length-prefixed message and receives one from the peer at the same
+// time, so two processes exchanging large messages cannot block on each other.
+static bool exchangeMessage(int fd, const std::vector<uint8_t>& out, std::vector<uint8_t>& in) {
+    uint64_t outSize = out.size();
+    std::vector<uint8_t> frame(sizeof(outSize) + out.size());
+    std::memcpy(frame.data(), &outSize, sizeof(outSize));
+    if (!out.empty()) std::memcpy(frame.data() + sizeof(outSize), out.data(), out.size());
+
+    size_t sent = 0;
+    size_t received = 0;
+    uint64_t inSize = 0;
+    bool haveSize = false;
+    in.clear();
+
+    while (sent < frame.size() || !haveSize || received < sizeof(inSize) + inSize) {
+        pollfd p{fd, 0, 0};
+        if (sent < frame.size()) p.events |= POLLOUT;
+        if (!haveSize || received < sizeof(inSize) + inSize) p.events |= POLLIN;
+        if (poll(&p, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (p.revents & (POLLERR | POLLNVAL)) return false;
+
+        if (p.revents & POLLOUT) {
+            ssize_t n = send(fd, frame.data() + sent, frame.size() - sent, MSG_DONTWAIT);
+            if (n > 0) sent += n;
+            else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+        }
+        if (p.revents & (POLLIN | POLLHUP)) {
+            ssize_t n;
+            if (!haveSize) {
+                n = recv(fd, reinterpret_cast<uint8_t*>(&inSize) + received, sizeof(inSize) - received, MSG_DONTWAIT);
+            } else {
+                n = recv(fd, in.data() + (received - sizeof(inSize)), sizeof(inSize) + inSize - received, MSG_DONTWAIT);
+            }
+            if (n == 0) return false;  // Peer went away
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+                continue;
+            }
+            received += n;
+            if (!haveSize && received == sizeof(inSize)) {
+                haveSize = true;
+                in.resize(inSize);
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T>
+static void writeValue(std::vector<uint8_t>& out, const T& value) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+static bool readValue(const std::vector<uint8_t>& in, size_t& at, T& value) {
+    if (at + sizeof(T) > in.size()) return false;
+    std::memcpy(&value, in.data() + at, sizeof(T));
+    at += sizeof(T);
+    return true;
+}
+
+// ------------------ Worker ------------------
+
+// Header of the per-link message sent after every step
+struct HaloHeader {
+    uint32_t migrantCount;
+    uint32_t haloCount;
+    uint32_t ownedCount;
+    float proposal;  // New boundary position, NaN for none
+    float width;     // Sender's strip width before this exchange
+};
+
+// State of one domain process
+struct DomainProcess {
+    int rank;
+    float bounds[2];       // Left and right edge; +-infinity at the ends of the world
+    int links[2];          // Socket to the left and right neighbour, -1 for none
+    int neighbourCount[2];
+    float haloWidth;
+    int balanceInterval;
+    const std::vector<Collider*>* colliders;
+
+    std::vector<RigidBody> statics;
+    std::vector<RigidBody> owned;
+    std::vector<DistributedBody> ownedRecords;  // Identity and collider of each owned body
+    std::vector<RigidBody> ghosts;
+    std::vector<uint32_t> ghostIds;                     // globalId of each ghost
+    std::vector<RigidBody> lastGhosts;                  // Ghosts of the step just taken...
+    std::unordered_map<uint32_t, size_t> lastGhostIndex;  // ...by globalId
+    std::vector<RigidBody*> stepList;
+
+    DistributedBody toRecord(int i) const {
+        DistributedBody record = ownedRecords[i];
+        record.state = owned[i].getState();
+        return record;
+    }
+
+    // A body that was a ghost here last step is reused, so it keeps its local id
+    // and pairs straddling a boundary stay in the contact cache
+    RigidBody fromRecord(const DistributedBody& record) const {
+        auto last = lastGhostIndex.find(record.globalId);
+        if (last != lastGhostIndex.end()) {
+            RigidBody body = lastGhosts[last->second];
+            body.setState(record.state);
+            return body;
+        }
+        RigidBody body(record.state.position, record.mass);
+        body.setRestitution(record.restitution);
+        body.setFriction(record.friction);
+        if (record.collider >= 0) body.setCollider((*colliders)[record.collider]);
+        body.setState(record.state);
+        return body;
+    }
+
+    void adopt(const DistributedBody& record) {
+        owned.push_back(fromRecord(record));
+        ownedRecords.push_back(record);
+    }
+
+    void removeOwned(size_t i) {
+        owned[i] = owned.back();
+        owned.pop_back();
+        ownedRecords[i] = ownedRecords.back();
+        ownedRecords.pop_back();
+    }
+
+    // Boundary that hands k of our bodies to the neighbour on that side
+    float propose(int side, const std::vector<float>& xs) const {
+        int mine = static_cast<int>(xs.size());
+        int theirs = neighbourCount[side];
+        if (mine <= theirs + theirs / 10 + 4) return std::numeric_limits<float>::quiet_NaN();
+        int k = (mine - theirs) / 2;
+        return side == 0 ? xs[k] : xs[mine - k];
+    }
+
+    // Where a shared boundary ends up. Both ends of the link get the same inputs
+    // and so the same answer. A boundary may take at most half of each strip's
+    // spare width (beyond two halos), so even when both of a strip's boundaries
+    // move in at once it keeps two halos.
+    float settle(float oldBound, float a, float b, float leftWidth, float rightWidth) const {
+        float moved = std::isnan(a) ? b : (std::isnan(b) ? a : 0.5f * (a + b));
+        if (std::isnan(moved)) return oldBound;
+        float minWidth = 2.0f * haloWidth;
+        float lo = oldBound - std::max(0.0f, leftWidth - minWidth) * 0.5f;
+        float hi = oldBound + std::max(0.0f, rightWidth - minWidth) * 0.5f;
+        return std::min(hi, std::max(lo, moved));
+    }
+
+    bool exchange(int step) {
+        bool balance = step >= 0 && balanceInterval > 0 && (step + 1) % balanceInterval == 0;
+        std::vector<DistributedBody> migrants[2];
+        std::vector<DistributedBody> halo[2];
+
+        // Bodies that left the strip go to the neighbour on that side. They are
+        // right at the boundary and missing from the neighbour's halo this time,
+        // so they stay here as ghosts for one step.
+        lastGhosts.swap(ghosts);
+        lastGhostIndex.clear();
+        for (size_t i = 0; i < lastGhosts.size(); i++) lastGhostIndex[ghostIds[i]] = i;
+        ghosts.clear();
+        ghostIds.clear();
+        for (size_t i = 0; i < owned.size();) {
+            float x = owned[i].getPosition().x;
+            int side = x < bounds[0] ? 0 : (x >= bounds[1] ? 1 : -1);
+            if (side < 0 || links[side] < 0) {
+                i++;
+                continue;
+            }
+            migrants[side].push_back(toRecord(static_cast<int>(i)));
+            ghosts.push_back(owned[i]);
+            ghostIds.push_back(ownedRecords[i].globalId);
+            removeOwned(i);
+        }
+
+        // Bodies near an edge are mirrored to that neighbour as ghosts
+        for (size_t i = 0; i < owned.size(); i++) {
+            float x = owned[i].getPosition().x;
+            if (links[0] >= 0 && x < bounds[0] + haloWidth) halo[0].push_back(toRecord(static_cast<int>(i)));
+            if (links[1] >= 0 && x >= bounds[1] - haloWidth) halo[1].push_back(toRecord(static_cast<int>(i)));
+        }
+
+        // Both proposals come from the strip as it was before either boundary moves
+        float proposals[2] = {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN()};
+        const float oldBounds[2] = {bounds[0], bounds[1]};
+        const float width = bounds[1] - bounds[0];
+        if (balance && !owned.empty()) {
+            std::vector<float> xs(owned.size());
+            for (size_t i = 0; i < owned.size(); i++) xs[i] = owned[i].getPosition().x;
+            std::sort(xs.begin(), xs.end());
+            for (int side = 0; side < 2; side++) {
+                if (links[side] >= 0) proposals[side] = propose(side, xs);
+            }
+        }
+
+        std::vector<uint8_t> out, in;
+        for (int side = 0; side < 2; side++) {
+            if (links[side] < 0) continue;
+
+            out.clear();
+            HaloHeader header{static_cast<uint32_t>(migrants[side].size()), static_cast<uint32_t>(halo[side].size()),
+                              static_cast<uint32_t>(owned.size()), proposals[side], width};
+            writeValue(out, header);
+            for (const DistributedBody& record : migrants[side]) writeValue(out, record);
+            for (const DistributedBody& record : halo[side]) writeValue(out, record);
+            if (!exchangeMessage(links[side], out, in)) return false;
+
+            size_t at = 0;
+            HaloHeader received;
+            if (!readValue(in, at, received)) return false;
+            for (uint32_t i = 0; i < received.migrantCount + received.haloCount; i++) {
+                DistributedBody record;
+                if (!readValue(in, at, record)) return false;
+                if (i < received.migrantCount) {
+                    adopt(record);
+                } else {
+                    ghosts.push_back(fromRecord(record));
+                    ghostIds.push_back(record.globalId);
+                }
+            }
+            neighbourCount[side] = static_cast<int>(received.ownedCount);
+
+            // Both ends of the link see both proposals and settle on the same boundary
+            if (balance) {
+                float leftWidth = side == 0 ? received.width : width;
+                float rightWidth = side == 0 ? width : received.width;
+                bounds[side] = settle(oldBounds[side], proposals[side], received.proposal, leftWidth, rightWidth);
+            }
+        }
+        return true;
+    }
+};
+
+// ------------------ Run ------------------
+
+bool DistributedWorld::run(int processes, int steps, float dt,
+                           const std::function<void(int, int, const std::vector<DistributedBody>&)>& onStep) {
+    processes = std::max(1, processes);
+    const float inf = std::numeric_limits<float>::infinity();
+
+    // Initial boundaries at body-count quantiles along x
+    std::vector<float> xs;
+    for (const DistributedBody& record : bodies) xs.push_back(record.state.position.x);
+    std::sort(xs.begin(), xs.end());
+    std::vector<float> splits(processes + 1);
+    splits[0] = -inf;
+    splits[processes] = inf;
+    for (int r = 1; r < processes; r++) {
+        splits[r] = xs.empty() ? -worldWidth / 2 + worldWidth * r / processes : xs[xs.size() * r / processes];
+    }
+    // A dense cluster can put quantiles on top of each other; no strip starts thinner than two halos
+    for (int r = 2; r < processes; r++) splits[r] = std::max(splits[r], splits[r - 1] + 2.0f * haloWidth);
+
+    // One socket pair per neighbouring pair, plus one per worker back to us
+    std::vector<int> linkFds(2 * std::max(0, processes - 1), -1);
+    std::vector<int> resultFds(2 * processes, -1);
+    bool ok = true;
+    for (int i = 0; i + 1 < processes && ok; i++) ok = socketpair(AF_UNIX, SOCK_STREAM, 0, &linkFds[2 * i]) == 0;
+    for (int i = 0; i < processes && ok; i++) ok = socketpair(AF_UNIX, SOCK_STREAM, 0, &resultFds[2 * i]) == 0;
+
+    // Pending stdio output would otherwise be written once per process
+    std::fflush(nullptr);
+
+    std::vector<pid_t> children;
+    for (int rank = 0; rank < processes && ok; rank++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            ok = false;
+            break;
+        }
+        if (pid > 0) {
+            children.push_back(pid);
+            continue;
+        }
+
+        // ---- Worker process ----
+        // Link i joins rank i (end 0) and rank i + 1 (end 1)
+        int left = rank > 0 ? linkFds[2 * (rank - 1) + 1] : -1;
+        int right = rank + 1 < processes ? linkFds[2 * rank] : -1;
+        int result = resultFds[2 * rank + 1];
+        for (int fd : linkFds) if (fd != left && fd != right && fd >= 0) close(fd);
+        for (int fd : resultFds) if (fd != result && fd >= 0) close(fd);
+
+        Physics physics(worldWidth, worldHeight, gravity);
+        DomainProcess domain;
+        domain.rank = rank;
+        domain.bounds[0] = splits[rank];
+        domain.bounds[1] = splits[rank + 1];
+        domain.links[0] = left;
+        domain.links[1] = right;
+        domain.neighbourCount[0] = domain.neighbourCount[1] = 0;
+        domain.haloWidth = haloWidth;
+        domain.balanceInterval = balanceInterval;
+        domain.colliders = &colliders;
+        domain.statics = staticBodies;
+        for (const DistributedBody& record : bodies) {
+            float x = record.state.position.x;
+            if (x >= domain.bounds[0] && x < domain.bounds[1]) domain.adopt(record);
+        }
+
+        // Ghosts and neighbour counts are in place before the first step
+        bool good = domain.exchange(-1);
+        for (int step = 0; step < steps && good; step++) {
+            domain.stepList.clear();
+            for (RigidBody& body : domain.statics) domain.stepList.push_back(&body);
+            for (RigidBody& body : domain.owned) domain.stepList.push_back(&body);
+            for (RigidBody& body : domain.ghosts) domain.stepList.push_back(&body);
+            physics.step(domain.stepList, dt);
+
+            good = domain.exchange(step);
+            if (good && onStep) {
+                for (size_t i = 0; i < domain.owned.size(); i++) domain.ownedRecords[i].state = domain.owned[i].getState();
+                onStep(rank, step, domain.ownedRecords);
+            }
+        }
+
+        // Report back: bounds, then every owned body
+        std::vector<uint8_t> out, in;
+        if (good) {
+            writeValue(out, domain.bounds[0]);
+            writeValue(out, domain.bounds[1]);
+            writeValue(out, static_cast<uint32_t>(domain.owned.size()));
+            for (size_t i = 0; i < domain.owned.size(); i++) writeValue(out, domain.toRecord(static_cast<int>(i)));
+            good = exchangeMessage(result, out, in);
+        }
+        std::fflush(nullptr);  // _exit skips it, and onStep may have printed
+        _exit(good ? 0 : 1);
+    }
+
+    // ---- Parent ----
+    for (int fd : linkFds) if (fd >= 0) close(fd);
+    for (int i = 0; i < processes; i++) {
+        if (resultFds[2 * i + 1] >= 0) close(resultFds[2 * i + 1]);
+    }
+
+    std::vector<DistributedBody> gathered;
+    std::vector<DomainInfo> info;
+    for (int rank = 0; rank < static_cast<int>(children.size()); rank++) {
+        std::vector<uint8_t> in;
+        size_t at = 0;
+        DomainInfo domain;
+        uint32_t count = 0;
+        if (!exchangeMessage(resultFds[2 * rank], std::vector<uint8_t>(), in) ||
+            !readValue(in, at, domain.left) || !readValue(in, at, domain.right) || !readValue(in, at, count)) {
+            ok = false;
+            continue;
+        }
+        domain.bodyCount = static_cast<int>(count);
+        for (uint32_t i = 0; i < count; i++) {
+            DistributedBody record;
+            if (!readValue(in, at, record)) {
+                ok = false;
+                break;
+            }
+            gathered.push_back(record);
+        }
+        info.push_back(domain);
+    }
+    for (int i = 0; i < processes; i++) {
+        if (resultFds[2 * i] >= 0) close(resultFds[2 * i]);
+    }
+
+    for (pid_t pid : children) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    if (!ok || gathered.size() != bodies.size()) return false;
+
+    std::sort(gathered.begin(), gathered.end(),
+              [](const DistributedBody& a, const DistributedBody& b) { return a.globalId < b.globalId; });
+    bodies.swap(gathered);
+    domains.swap(info);
+    return true;
+}
@@ -0,0 +1,467 @@
+#include "ParticleSystem.h"
+#include "ThreadPool.h"
+#include "Integrator.h"
+#include <OpenGL/gl.h>
+#include <algorithm>
+#include <cmath>
+
+ParticleSystem::ParticleSystem(float radius, float mass, float restitution)
+    : radius(radius),
+      mass(mass),
+      restitution(restitution),
+      iterations(2),
+      categoryBits(0x0001),
+      maskBits(0xFFFF)
+{}
+
+void ParticleSystem::reserve(int count) {
+    posX.reserve(count);
+    posY.reserve(count);
+    velX.reserve(count);
+    velY.reserve(count);
+    ids.reserve(count);
+}
+
+int ParticleSystem::addParticle(const Vector2D& pos, const Vector2D& vel) {
+    posX.push_back(pos.x);
+    posY.push_back(pos.y);
+    velX.push_back(vel.x);
+    velY.push_back(vel.y);
+    ids.push_back(static_cast<uint32_t>(ids.size()));
+    return static_cast<int>(posX.size()) - 1;
+}
+
+void ParticleSystem::clear() {
+    posX.clear();
+    posY.clear();
+    velX.clear();
+    velY.clear();
+    ids.clear();
+}
+
+// ------------------ Step ------------------
+
+void ParticleSystem::integrate(float dt, const Vector2D& gravity) {
+    const int n = getCount();
+    float* __restrict px = posX.data();
+    float* __restrict py = posY.data();
+    float* __restrict vx = velX.data();
+    float* __restrict vy = velY.data();
+
+    // Semi-implicit Euler, same as RigidBody::update
+    integrateSemiImplicit(px, py, vx, vy, n, gravity, dt);
+
+    if (wrapX) {
+        float minX = -periodX / 2;
+        for (int i = 0; i < n; i++) px[i] -= periodX * std::floor((px[i] - minX) / periodX);
+    }
+    if (wrapY) {
+        float minY = -periodY / 2;
+        for (int i = 0; i < n; i++) py[i] -= periodY * std::floor((py[i] - minY) / periodY);
+    }
+}
+
+void ParticleSystem::buildGrid(const Physics& physics) {
+    const int n = getCount();
+    const float diameter = 2.0f * radius;
+
+    // Periodic axes span the world exactly so neighbour cells can wrap;
+    // other axes just cover the particles
+    float minX = posX[0], maxX = posX[0], minY = posY[0], maxY = posY[0];
+    for (int i = 1; i < n; i++) {
+        minX = std::min(minX, posX[i]);
+        maxX = std::max(maxX, posX[i]);
+        minY = std::min(minY, posY[i]);
+        maxY = std::max(maxY, posY[i]);
+    }
+    cellW = diameter;
+    cellH = diameter;
+    if (wrapX) {
+        gridMinX = -physics.getWorldWidth() / 2;
+        gridW = std::max(1, static_cast<int>(periodX / diameter));
+        cellW = periodX / gridW;
+    } else {
+        gridMinX = minX;
+        gridW = static_cast<int>((maxX - minX) / cellW) + 1;
+    }
+    if (wrapY) {
+        gridMinY = -physics.getWorldHeight() / 2;
+        gridH = std::max(1, static_cast<int>(periodY / diameter));
+        cellH = periodY / gridH;
+    } else {
+        gridMinY = minY;
+        gridH = static_cast<int>((maxY - minY) / cellH) + 1;
+    }
+
+    // Sparse clouds: coarsen the free axes so the grid stays near O(n) cells
+    const int64_t cellLimit = std::max<int64_t>(4096, 4 * static_cast<int64_t>(n));
+    while (static_cast<int64_t>(gridW) * gridH > cellLimit && (!wrapX || !wrapY)) {
+        if (!wrapX) {
+            cellW *= 2.0f;
+            gridW = static_cast<int>((maxX - minX) / cellW) + 1;
+        }
+        if (!wrapY) {
+            cellH *= 2.0f;
+            gridH = static_cast<int>((maxY - minY) / cellH) + 1;
+        }
+    }
+
+    const int cells = gridW * gridH;
+    const float invW = 1.0f / cellW;
+    const float invH = 1.0f / cellH;
+    cellOf.resize(n);
+    for (int i = 0; i < n; i++) {
+        int cx = std::min(gridW - 1, std::max(0, static_cast<int>((posX[i] - gridMinX) * invW)));
+        int cy = std::min(gridH - 1, std::max(0, static_cast<int>((posY[i] - gridMinY) * invH)));
+        cellOf[i] = cy * gridW + cx;
+    }
+
+    // Counting sort: histogram, prefix sum, destination per particle
+    cellStart.assign(cells + 1, 0);
+    for (int i = 0; i < n; i++) cellStart[cellOf[i] + 1]++;
+    for (int c = 0; c < cells; c++) cellStart[c + 1] += cellStart[c];
+    destination.resize(n);
+    for (int i = 0; i < n; i++) {
+        destination[i] = cellStart[cellOf[i]]++;
+    }
+    // The scatter advanced every start to the next cell's start; shift them back
+    for (int c = cells; c > 0; c--) cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+
+    // Physically reorder the SoA arrays into cell order for cache-friendly neighbour scans
+    scratch.resize(n);
+    for (std::vector<float>* field : {&posX, &posY, &velX, &velY}) {
+        for (int i = 0; i < n; i++) scratch[destination[i]] = (*field)[i];
+        field->swap(scratch);
+    }
+    scratchIds.resize(n);
+    for (int i = 0; i < n; i++) scratchIds[destination[i]] = ids[i];
+    ids.swap(scratchIds);
+}
+
+// Contact response of one particle against the contiguous slot range [begin, end).
+// Ranges are short (a few particles per cell), so an early out on separated
+// pairs beats a branch-free vector loop here; the win comes from the sorted SoA
+// layout keeping every range in cache.
+static inline void neighbourKernel(float xi, float yi, float vxi, float vyi,
+                                   const float* __restrict x, const float* __restrict y,
+                                   const float* __restrict vx, const float* __restrict vy,
+                                   int begin, int end, float shiftX, float shiftY,
+                                   float diameter, float bounce,
+                                   float& corrX, float& corrY, float& dvX, float& dvY) {
+    const float reach = diameter * diameter;
+    float cx = 0.0f, cy = 0.0f, ax = 0.0f, ay = 0.0f;
+    for (int j = begin; j < end; j++) {
+        float dx = x[j] + shiftX - xi;
+        float dy = y[j] + shiftY - yi;
+        float d2 = dx * dx + dy * dy;
+        // Self and exactly coincident particles are skipped, like coincident circles
+        if (d2 >= reach || d2 < 1e-12f) continue;
+        float inv = 1.0f / std::sqrt(d2);
+        float nx = dx * inv;
+        float ny = dy * inv;
+        float overlap = diameter - d2 * inv;
+
+        // Each particle of the pair takes half the separation
+        cx -= nx * overlap * 0.5f;
+        cy -= ny * overlap * 0.5f;
+
+        // Equal masses: each side takes half of the restitution impulse
+        float vn = (vx[j] - vxi) * nx + (vy[j] - vyi) * ny;
+        float approach = std::min(vn, 0.0f);
+        ax += nx * approach * bounce;
+        ay += ny * approach * bounce;
+    }
+    corrX += cx;
+    corrY += cy;
+    dvX += ax;
+    dvY += ay;
+}
+
+// Neighbour cells of cell c along one axis, each with the shift that brings it
+// next to c. A wrapped axis under three cells wide has every cell at every
+// image offset, since the same cell can be a neighbour on both sides.
+static int axisNeighbours(int c, int size, bool wrap, float period, int* cells, float* shifts) {
+    int count = 0;
+    if (wrap && size < 3) {
+        for (int image = -1; image <= 1; image++) {
+            for (int n = 0; n < size; n++) {
+                cells[count] = n;
+                shifts[count++] = image * period;
+            }
+        }
+        return count;
+    }
+    for (int o = -1; o <= 1; o++) {
+        int n = c + o;
+        float shift = 0.0f;
+        if (n < 0 || n >= size) {
+            if (!wrap) continue;
+            shift = n < 0 ? -period : period;
+            n = n < 0 ? n + size : n - size;
+        }
+        cells[count] = n;
+        shifts[count++] = shift;
+    }
+    return count;
+}
+
+void ParticleSystem::solveParticles(bool applyVelocity) {
+    const int n = getCount();
+    const int cells = gridW * gridH;
+    const float diameter = 2.0f * radius;
+    const float bounce = (1.0f + restitution) * 0.5f;
+
+    corrX.assign(n, 0.0f);
+    corrY.assign(n, 0.0f);
+    deltaVX.assign(n, 0.0f);
+    deltaVY.assign(n, 0.0f);
+
+    const float* x = posX.data();
+    const float* y = posY.data();
+    const float* vx = velX.data();
+    const float* vy = velY.data();
+
+    ThreadPool::shared().parallelFor(cells, 256, [&](int begin, int end) {
+        int rowCells[9], columnCells[9];
+        float rowShifts[9], columnShifts[9];
+        for (int c = begin; c < end; c++) {
+            int cx = c % gridW;
+            int cy = c / gridW;
+            int rows = axisNeighbours(cy, gridH, wrapY, periodY, rowCells, rowShifts);
+            int columns = wrapX ? axisNeighbours(cx, gridW, true, periodX, columnCells, columnShifts) : 0;
+            for (int i = cellStart[c]; i < cellStart[c + 1]; i++) {
+                float cxi = 0.0f, cyi = 0.0f, dvx = 0.0f, dvy = 0.0f;
+                for (int r = 0; r < rows; r++) {
+                    int row = rowCells[r] * gridW;
+                    if (!wrapX) {
+                        // The three cells of this row are one contiguous slot range
+                        int x0 = std::max(0, cx - 1);
+                        int x1 = std::min(gridW - 1, cx + 1);
+                        neighbourKernel(x[i], y[i], vx[i], vy[i], x, y, vx, vy,
+                                        cellStart[row + x0], cellStart[row + x1 + 1], 0.0f, rowShifts[r],
+                                        diameter, bounce, cxi, cyi, dvx, dvy);
+                        continue;
+                    }
+                    for (int k = 0; k < columns; k++) {
+                        int nx = columnCells[k];
+                        neighbourKernel(x[i], y[i], vx[i], vy[i], x, y, vx, vy,
+                                        cellStart[row + nx], cellStart[row + nx + 1], columnShifts[k], rowShifts[r],
+                                        diameter, bounce, cxi, cyi, dvx, dvy);
+                    }
+                }
+                corrX[i] = cxi;
+                corrY[i] = cyi;
+                deltaVX[i] = dvx;
+                deltaVY[i] = dvy;
+            }
+        }
+    });
+
+    for (int i = 0; i < n; i++) {
+        posX[i] += corrX[i];
+        posY[i] += corrY[i];
+    }
+    if (applyVelocity) {
+        for (int i = 0; i < n; i++) {
+            velX[i] += deltaVX[i];
+            velY[i] += deltaVY[i];
+        }
+    }
+}
+
+void ParticleSystem::collideBody(RigidBody& body) {
+    Collider* collider = body.getCollider();
+    if (!collider || collider->isSensor()) return;
+    if (collider->getType() == ColliderType::Plane) return;  // Bounds are handled separately
+    if (!Collider::shouldCollide(categoryBits, maskBits, collider->getCategoryBits(), collider->getMaskBits())) return;
+
+    const float invMassP = mass > 0.0f ? 1.0f / mass : 0.0f;
+    const float invMassB = (body.isStaticBody() || body.getMass() <= 0.0f) ? 0.0f : 1.0f / body.getMass();
+    const float invMassSum = invMassP + invMassB;
+    if (invMassSum <= 0.0f) return;
+    const float e = std::min(restitution, body.getRestitution());
+
+    Vector2D center = body.getPosition();
+    Vector2D bodyVel = body.getVelocity();
+    Vector2D bodyShift;
+    bool isCircle = collider->getType() == ColliderType::Circle;
+    float bodyRadius = collider->getRadius();
+    float hw = collider->getWidth() / 2.0f;
+    float hh = collider->getHeight() / 2.0f;
+    float c = body.getCosAngle();
+    float s = body.getSinAngle();
+
+    // Near a periodic seam the particles on the far side meet a copy of the
+    // body shifted by one period
+    AABB bounds = body.getAABB();
+    float imagesX[3] = {0.0f}, imagesY[3] = {0.0f};
+    int countX = 1, countY = 1;
+    if (wrapX) {
+        if (bounds.min.x - radius < gridMinX) imagesX[countX++] = periodX;
+        if (bounds.max.x + radius > gridMinX + periodX) imagesX[countX++] = -periodX;
+    }
+    if (wrapY) {
+        if (bounds.min.y - radius < gridMinY) imagesY[countY++] = periodY;
+        if (bounds.max.y + radius > gridMinY + periodY) imagesY[countY++] = -periodY;
+    }
+
+    for (int image = 0; image < countX * countY; image++) {
+        Vector2D offset(imagesX[image % countX], imagesY[image / countX]);
+        Vector2D imageCenter = center + offset;
+
+        // Cells under the image's bounds, padded by one cell for particles moved by the solver
+        int x0 = static_cast<int>(std::floor((bounds.min.x + offset.x - radius - gridMinX) / cellW)) - 1;
+        int x1 = static_cast<int>(std::floor((bounds.max.x + offset.x + radius - gridMinX) / cellW)) + 1;
+        int y0 = static_cast<int>(std::floor((bounds.min.y + offset.y - radius - gridMinY) / cellH)) - 1;
+        int y1 = static_cast<int>(std::floor((bounds.max.y + offset.y + radius - gridMinY) / cellH)) + 1;
+        if (x1 < 0 || y1 < 0 || x0 >= gridW || y0 >= gridH) continue;
+        x0 = std::max(0, x0);
+        y0 = std::max(0, y0);
+        x1 = std::min(gridW - 1, x1);
+        y1 = std::min(gridH - 1, y1);
+
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int i = cellStart[cy * gridW + x0]; i < cellStart[cy * gridW + x1 + 1]; i++) {
+                float dx = posX[i] - imageCenter.x;
+                float dy = posY[i] - imageCenter.y;
+                float nx, ny, overlap;
+
+                if (isCircle) {
+                    float d2 = dx * dx + dy * dy;
+                    float reach = bodyRadius + radius;
+                    if (d2 >= reach * reach || d2 < 1e-12f) continue;
+                    float d = std::sqrt(d2);
+                    nx = dx / d;
+                    ny = dy / d;
+                    overlap = reach - d;
+                } else {
+                    // Closest point on the rectangle in its local frame
+                    float lx = dx * c + dy * s;
+                    float ly = -dx * s + dy * c;
+                    float qx = std::max(-hw, std::min(hw, lx));
+                    float qy = std::max(-hh, std::min(hh, ly));
+                    float ex = lx - qx, ey = ly - qy;
+                    float d2 = ex * ex + ey * ey;
+                    float lnx, lny;
+                    if (d2 > 1e-12f) {
+                        if (d2 >= radius * radius) continue;
+                        float d = std::sqrt(d2);
+                        lnx = ex / d;
+                        lny = ey / d;
+                        overlap = radius - d;
+                    } else {
+                        // Center inside: push out through the nearest face
+                        float px = hw - std::abs(lx), py = hh - std::abs(ly);
+                        if (px < py) { lnx = lx >= 0 ? 1.0f : -1.0f; lny = 0.0f; overlap = px + radius; }
+                        else { lnx = 0.0f; lny = ly >= 0 ? 1.0f : -1.0f; overlap = py + radius; }
+                    }
+                    nx = lnx * c - lny * s;
+                    ny = lnx * s + lny * c;
+                }
+
+                // Split the separation by inverse mass
+                posX[i] += nx * overlap * (invMassP / invMassSum);
+                posY[i] += ny * overlap * (invMassP / invMassSum);
+                bodyShift = bodyShift - Vector2D(nx, ny) * (overlap * (invMassB / invMassSum));
+
+                // Equal and opposite impulse along the normal
+                float vn = (velX[i] - bodyVel.x) * nx + (velY[i] - bodyVel.y) * ny;
+                if (vn < 0.0f) {
+                    float j = -(1.0f + e) * vn / invMassSum;
+                    velX[i] += nx * j * invMassP;
+                    velY[i] += ny * j * invMassP;
+                    bodyVel = bodyVel - Vector2D(nx, ny) * (j * invMassB);
+                }
+            }
+        }
+    }
+
+    if (invMassB > 0.0f) {
+        body.setPosition(center + bodyShift);
+        body.setVelocity(bodyVel);
+    }
+}
+
+void ParticleSystem::collideBounds(const Physics& physics) {
+    const int n = getCount();
+    const float left = -physics.getWorldWidth() / 2 + radius;
+    const float right = physics.getWorldWidth() / 2 - radius;
+    const float bottom = -physics.getWorldHeight() / 2 + radius;
+    const float top = physics.getWorldHeight() / 2 - radius;
+    float* __restrict px = posX.data();
+    float* __restrict py = posY.data();
+    float* __restrict vx = velX.data();
+    float* __restrict vy = velY.data();
+    const float e = restitution;
+
+    // Same response as a wall plane: clamp, then reflect the inbound velocity
+    if (physics.getBoundary(BoundarySide::Left) == BoundaryMode::Solid) {
+        for (int i = 0; i < n; i++) {
+            bool hit = px[i] < left;
+            px[i] = hit ? left : px[i];
+            vx[i] = (hit && vx[i] < 0.0f) ? -vx[i] * e : vx[i];
+        }
+    }
+    if (physics.getBoundary(BoundarySide::Right) == BoundaryMode::Solid) {
+        for (int i = 0; i < n; i++) {
+            bool hit = px[i] > right;
+            px[i] = hit ? right : px[i];
+            vx[i] = (hit && vx[i] > 0.0f) ? -vx[i] * e : vx[i];
+        }
+    }
+    if (physics.getBoundary(BoundarySide::Bottom) == BoundaryMode::Solid) {
+        for (int i = 0; i < n; i++) {
+            bool hit = py[i] < bottom;
+            py[i] = hit ? bottom : py[i];
+            vy[i] = (hit && vy[i] < 0.0f) ? -vy[i] * e : vy[i];
+        }
+    }
+    if (physics.getBoundary(BoundarySide::Top) == BoundaryMode::Solid) {
+        for (int i = 0; i < n; i++) {
+            bool hit = py[i] > top;
+            py[i] = hit ? top : py[i];
+            vy[i] = (hit && vy[i] > 0.0f) ? -vy[i] * e : vy[i];
+        }
+    }
+}
+
+void ParticleSystem::step(float dt, const Physics& physics, std::vector<RigidBody*>& bodies) {
+    if (posX.empty()) return;
+
+    wrapX = physics.getBoundary(BoundarySide::Left) == BoundaryMode::Periodic;
+    wrapY = physics.getBoundary(BoundarySide::Bottom) == BoundaryMode::Periodic;
+    periodX = physics.getWorldWidth();
+    periodY = physics.getWorldHeight();
+
+    integrate(dt, physics.getGravity());
+    buildGrid(physics);
+    for (int i = 0; i < iterations; i++) {
+        solveParticles(i == 0);
+    }
+    for (RigidBody* body : bodies) {
+        collideBody(*body);
+    }
+    collideBounds(physics);
+}
+
+// ------------------ Rendering ------------------
+
+void ParticleSystem::draw() const {
+    const int n = getCount();
+    if (n == 0) return;
+
+    // Interleave into one vertex array in pixels and draw everything in one call
+    drawBuffer.resize(2 * static_cast<size_t>(n));
+    for (int i = 0; i < n; i++) {
+        drawBuffer[2 * i] = posX[i] * RigidBody::pixelsPerMeter;
+        drawBuffer[2 * i + 1] = posY[i] * RigidBody::pixelsPerMeter;
+    }
+
+    glColor3f(0.2f, 0.7f, 1.0f);  // Cyan, like dynamic bodies
+    glPointSize(std::max(1.0f, 2.0f * radius * RigidBody::pixelsPerMeter));
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, drawBuffer.data());
+    glDrawArrays(GL_POINTS, 0, n);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
@@ -1,10 +1,26 @@
 #include "Physics.h"
+#include "Narrowphase.h"
 #include "RectangleCollider.h"
+#include "StateExport.h"
+#include "ThreadPool.h"
+#include <limits>
 #include <algorithm>
 #include <cmath>
 
 Physics::Physics(float width, float height, const Vector2D& grav) 
-    : worldWidth(static_cast<int>(width)), worldHeight(static_cast<int>(height)), gravity(grav) {}
+    : worldWidth(width), worldHeight(height), gravity(grav),
+      boundaryPlanes{PlaneCollider(Vector2D(1, 0)), PlaneCollider(Vector2D(-1, 0)),
+                     PlaneCollider(Vector2D(0, 1)), PlaneCollider(Vector2D(0, -1))},
+      boundaryBodies{RigidBody(Vector2D(-width / 2, 0), 1.0f, true), RigidBody(Vector2D(width / 2, 0), 1.0f, true),
+                     RigidBody(Vector2D(0, -height / 2), 1.0f, true), RigidBody(Vector2D(0, height / 2), 1.0f, true)},
+      boundaryModes{BoundaryMode::Solid, BoundaryMode::Solid, BoundaryMode::Solid, BoundaryMode::Solid}
+{
+    for (int side = 0; side < 4; side++) {
+        boundaryBodies[side].setCollider(&boundaryPlanes[side]);
+        // Full restitution here so the bouncing body's own restitution decides
+        boundaryBodies[side].setRestitution(1.0f);
+    }
+}
 
 void Physics::applyGravity(RigidBody& body){
     if(!body.isStaticBody()){
@@ -12,287 +28,662 @@ void Physics::applyGravity(RigidBody& body){
     }
 }
 
-void Physics::checkWallCollisions(RigidBody& body) {
-    Collider* collider = body.getCollider();
-    if (!collider) return;
+void Physics::setBoundary(BoundarySide side, BoundaryMode mode) {
+    int index = static_cast<int>(side);
+    int opposite = index ^ 1;  // Left <-> Right, Bottom <-> Top
 
+    if (mode == BoundaryMode::Periodic) {
+        boundaryModes[index] = boundaryModes[opposite] = BoundaryMode::Periodic;
+    } else {
+        // Leaving periodic mode on one side turns the opposite side solid again
+        if (boundaryModes[index] == BoundaryMode::Periodic) {
+            boundaryModes[opposite] = BoundaryMode::Solid;
+        }
+        boundaryModes[index] = mode;
+    }
+    configureBroadphase();
+}
+
+void Physics::configureBroadphase() {
+    bool wrapX = boundaryModes[0] == BoundaryMode::Periodic;
+    bool wrapY = boundaryModes[2] == BoundaryMode::Periodic;
+    AABB domain{Vector2D(-worldWidth / 2, -worldHeight / 2), Vector2D(worldWidth / 2, worldHeight / 2)};
+    broadphase.setPeriodic(wrapX, wrapY, domain);
+}
+
+void Physics::wrapPeriodic(RigidBody& body) const {
     Vector2D pos = body.getPosition();
-    Vector2D vel = body.getVelocity();
-    bool collided = false;
+    bool wrapped = false;
+
+    if (boundaryModes[0] == BoundaryMode::Periodic) {
+        float shifted = pos.x + worldWidth / 2;
+        if (shifted < 0.0f || shifted >= worldWidth) {
+            pos.x = shifted - std::floor(shifted / worldWidth) * worldWidth - worldWidth / 2;
+            wrapped = true;
+        }
+    }
+    if (boundaryModes[2] == BoundaryMode::Periodic) {
+        float shifted = pos.y + worldHeight / 2;
+        if (shifted < 0.0f || shifted >= worldHeight) {
+            pos.y = shifted - std::floor(shifted / worldHeight) * worldHeight - worldHeight / 2;
+            wrapped = true;
+        }
+    }
+    if (wrapped) {
+        body.setPosition(pos);
+    }
+}
+
+// ------------------ Narrowphase ------------------
+
+// Thin adapters from bodies to the geometry tests in Narrowphase.h.
+// Each test fills contact on a hit. On a miss it fills separatingAxis (A to B)
+// when it found one, or leaves it zero.
+
+using Box = OrientedBox<float>;
+
+static Box makeBox(const RigidBody& body) {
+    // The body caches its rotation, so no trig per pair
+    Collider* collider = body.getCollider();
+    float c = body.getCosAngle();
+    float s = body.getSinAngle();
+    return Box{body.getPosition(), Vector2D(c, s), Vector2D(-s, c),
+               collider->getWidth() / 2.0f, collider->getHeight() / 2.0f};
+}
+
+// Circle vs circle. Normal points from A to B.
+static bool collideCircles(const RigidBody& bodyA, const RigidBody& bodyB, Contact& contact,
+                           Vector2D& separatingAxis) {
+    return circleVsCircle(bodyA.getPosition(), bodyA.getCollider()->getRadius(),
+                          bodyB.getPosition(), bodyB.getCollider()->getRadius(), contact, separatingAxis);
+}
+
+// Circle vs rotated rectangle. Normal points from the rectangle to the circle.
+static bool collideCircleRect(const RigidBody& circleBody, const RigidBody& rectBody, Contact& contact,
+                              Vector2D& separatingAxis) {
+    return circleVsBox(circleBody.getPosition(), circleBody.getCollider()->getRadius(), makeBox(rectBody),
+                       contact, separatingAxis);
+}
+
+// Half the length of any collider's shadow on an axis
+static float shapeExtent(const RigidBody& body, const Vector2D& axis) {
+    Collider* collider = body.getCollider();
+    if (collider->getType() == ColliderType::Circle) return collider->getRadius();
+    return boxExtent(makeBox(body), axis);
+}
+
+// True if the shapes' projections on axis (pointing A to B) do not overlap
+static bool separatedAlong(const RigidBody& bodyA, const RigidBody& bodyB, const Vector2D& axis) {
+    float gap = (bodyB.getPosition() - bodyA.getPosition()).dot(axis);
+    return gap - shapeExtent(bodyA, axis) - shapeExtent(bodyB, axis) > 0.0f;
+}
+
+// Rectangle vs rectangle. Normal points from A to B.
+static bool collideRects(const RigidBody& bodyA, const RigidBody& bodyB, Contact& contact,
+                         Vector2D& separatingAxis) {
+    return boxVsBox(makeBox(bodyA), makeBox(bodyB), contact, separatingAxis);
+}
+
+// Half-plane vs circle or rectangle. Normal is the plane normal (plane to shape).
+static bool collidePlane(const RigidBody& planeBody, const RigidBody& shapeBody, Contact& contact) {
+    Vector2D n = planeBody.getCollider()->getNormal();
+    Collider* shape = shapeBody.getCollider();
+
+    if (shape->getType() == ColliderType::Circle) {
+        return planeVsCircle(planeBody.getPosition(), n, shapeBody.getPosition(), shape->getRadius(), contact);
+    }
+    if (shape->getType() != ColliderType::Rectangle) {
+        contact.normal = n;
+        contact.pointCount = 0;
+        contact.depth = 0.0f;
+        return false;
+    }
+    return planeVsBox(planeBody.getPosition(), n, makeBox(shapeBody), contact);
+}
+
+// Dispatches on collider types. Normal in the result always points from A to B.
+static bool computeContact(const RigidBody& bodyA, const RigidBody& bodyB, Contact& contact,
+                           Vector2D& separatingAxis) {
+    ColliderType typeA = bodyA.getCollider()->getType();
+    ColliderType typeB = bodyB.getCollider()->getType();
+    separatingAxis = Vector2D();
+
+    if (typeA == ColliderType::Plane) {
+        return collidePlane(bodyA, bodyB, contact);
+    }
+    if (typeB == ColliderType::Plane) {
+        bool hit = collidePlane(bodyB, bodyA, contact);
+        contact.normal = contact.normal * -1.0f;
+        return hit;
+    }
+    if (typeA == ColliderType::Circle && typeB == ColliderType::Circle) {
+        return collideCircles(bodyA, bodyB, contact, separatingAxis);
+    }
+    if (typeA == ColliderType::Rectangle && typeB == ColliderType::Circle) {
+        return collideCircleRect(bodyB, bodyA, contact, separatingAxis);
+    }
+    if (typeA == ColliderType::Circle && typeB == ColliderType::Rectangle) {
+        bool hit = collideCircleRect(bodyA, bodyB, contact, separatingAxis);
+        contact.normal = contact.normal * -1.0f;
+        separatingAxis = separatingAxis * -1.0f;
+        return hit;
+    }
+    return collideRects(bodyA, bodyB, contact, separatingAxis);
+}
 
-    if (collider->getType() == ColliderType::Circle) {
-        float radius = collider->getRadius();
+// Pushes the bodies apart and reflects their velocities along the contact normal.
+// Returns the normal impulse that was applied.
+static float resolveContact(RigidBody& bodyA, RigidBody& bodyB, const Contact& contact) {
+    const Vector2D& normal = contact.normal;
+    float overlap = contact.depth;
+    Vector2D posA = bodyA.getPosition();
+    Vector2D posB = bodyB.getPosition();
+
+    // Separate the bodies (push them apart)
+    // If one is static, only move the non-static one
+    if (bodyA.isStaticBody()) {
+        posB = posB + normal * overlap;
+        bodyB.setPosition(posB);
+    } else if (bodyB.isStaticBody()) {
+        posA = posA - normal * overlap;
+        bodyA.setPosition(posA);
+    } else {
+        // Both are dynamic - separate proportionally by mass
+        float totalMass = bodyA.getMass() + bodyB.getMass();
+        float ratioA = bodyB.getMass() / totalMass;
+        float ratioB = bodyA.getMass() / totalMass;
+        
+        posA = posA - normal * (overlap * ratioA);
+        posB = posB + normal * (overlap * ratioB);
         
-        // Left wall
-        if (pos.x - radius < -worldWidth / 2) {
-            pos.x = -worldWidth / 2 + radius;
-            vel.x = -vel.x * body.getRestitution();
-            collided = true;
+        bodyA.setPosition(posA);
+        bodyB.setPosition(posB);
+    }
+    
+    // Calculate restitution
+    float restitution = std::min(bodyA.getRestitution(), bodyB.getRestitution());
+    float impulse = 0.0f;
+    
+    // Reflect velocity for body A (if not static)
+    if (!bodyA.isStaticBody()) {
+        Vector2D velA = bodyA.getVelocity();
+        float velAlongNormal = velA.dot(normal * -1.0f);
+        
+        if (velAlongNormal < 0) {
+            // Reflect velocity: newVel = vel - 2*(vel·normal)*normal
+            Vector2D newVel = velA + normal * (2.0f * velAlongNormal * (1.0f + restitution) * 0.5f);
+            bodyA.setVelocity(newVel);
+            impulse = std::max(impulse, -velAlongNormal * (1.0f + restitution) * bodyA.getMass());
         }
-        // Right wall
-        if (pos.x + radius > worldWidth / 2) {
-            pos.x = worldWidth / 2 - radius;
-            vel.x = -vel.x * body.getRestitution();
-            collided = true;
+    }
+    
+    // Reflect velocity for body B (if not static)
+    if (!bodyB.isStaticBody()) {
+        Vector2D velB = bodyB.getVelocity();
+        float velAlongNormal = velB.dot(normal);
+        
+        if (velAlongNormal < 0) {
+            // Reflect velocity: newVel = vel - 2*(vel·normal)*normal
+            Vector2D newVel = velB - normal * (2.0f * velAlongNormal * (1.0f + restitution) * 0.5f);
+            bodyB.setVelocity(newVel);
+            impulse = std::max(impulse, -velAlongNormal * (1.0f + restitution) * bodyB.getMass());
         }
-        // Bottom wall
-        if (pos.y - radius < -worldHeight / 2) {
-            pos.y = -worldHeight / 2 + radius;
-            vel.y = -vel.y * body.getRestitution();
-            collided = true;
+    }
+    return impulse;
+}
+
+// ------------------ Boundaries ------------------
+
+void Physics::checkWallCollisions(RigidBody& body) {
+    if (!body.getCollider() || body.isStaticBody()) return;
+    wrapPeriodic(body);
+
+    // Same narrowphase and response as in step(), without the contact cache
+    for (int side = 0; side < 4; side++) {
+        if (boundaryModes[side] != BoundaryMode::Solid) continue;
+        Contact contact;
+        Vector2D axis;
+        if (computeContact(boundaryBodies[side], body, contact, axis)) {
+            resolveContact(boundaryBodies[side], body, contact);
         }
-        // Top wall
-        if (pos.y + radius > worldHeight / 2) {
-            pos.y = worldHeight / 2 - radius;
-            vel.y = -vel.y * body.getRestitution();
-            collided = true;
+    }
+}
+
+// ------------------ Body collisions ------------------
+
+void Physics::collidePair(RigidBody* bodyA, RigidBody* bodyB, Vector2D shiftB) {
+    // Skip if both are static
+    if (bodyA->isStaticBody() && bodyB->isStaticBody()) return;
+
+    // The cache orders every pair by body id; work in that order so cached
+    // normals and axes keep their direction from step to step
+    bool added;
+    ContactPair* pair = contactCache.findOrAdd(bodyA, bodyB, frame, added);
+    pair->lastSeenFrame = frame;
+    if (pair->bodyA != bodyA) {
+        shiftB = shiftB * -1.0f;
+    }
+
+    // Pairs across a periodic seam: move B next to A for the test, then back
+    bool shifted = shiftB.x != 0.0f || shiftB.y != 0.0f;
+    if (shifted) {
+        pair->bodyB->setPosition(pair->bodyB->getPosition() + shiftB);
+    }
+    updatePair(pair);
+    if (shifted) {
+        pair->bodyB->setPosition(pair->bodyB->getPosition() - shiftB);
+    }
+}
+
+void Physics::updatePair(ContactPair* pair) {
+    RigidBody* bodyA = pair->bodyA;
+    RigidBody* bodyB = pair->bodyB;
+    bool wasTouching = pair->touching;
+
+    // Early out: the axis that separated the pair last step still does
+    if (!wasTouching && pair->hasSeparatingAxis && separatedAlong(*bodyA, *bodyB, pair->separatingAxis)) {
+        return;
+    }
+
+    Contact contact;
+    Vector2D axis;
+    pair->touching = computeContact(*bodyA, *bodyB, contact, axis);
+    pair->sensor = bodyA->getCollider()->isSensor() || bodyB->getCollider()->isSensor();
+
+    if (!pair->touching) {
+        pair->hasSeparatingAxis = axis.dot(axis) > 0.0f;
+        pair->separatingAxis = axis;
+        pair->touchingFrames = 0;
+        if (wasTouching && contactEventsEnabled) {
+            contactEvents.push_back(ContactEvent{ContactEventType::End, bodyA, bodyB,
+                                                 Vector2D(), Vector2D(), 0.0f, pair->sensor});
         }
+        return;
     }
-    
-    if (collided) {
-        body.setPosition(pos);
-        body.setVelocity(vel);
+
+    pair->hasSeparatingAxis = false;
+    pair->touchingFrames++;
+    pair->normal = contact.normal;
+    pair->pointCount = contact.pointCount;
+    for (int i = 0; i < contact.pointCount; i++) {
+        pair->points[i] = contact.points[i];
+        pair->normalImpulse[i] = 0.0f;
+    }
+
+    if (contactEventsEnabled) {
+        contactEvents.push_back(ContactEvent{wasTouching ? ContactEventType::Persist : ContactEventType::Begin,
+                                             bodyA, bodyB, contact.normal, contact.point, contact.depth,
+                                             pair->sensor});
+    }
+    if (!pair->sensor) {
+        // Spread the applied impulse over the manifold points
+        float impulse = resolveContact(*bodyA, *bodyB, contact);
+        for (int i = 0; i < contact.pointCount; i++) {
+            pair->normalImpulse[i] = impulse / contact.pointCount;
+        }
+    }
+}
+
+void Physics::gatherStepBodies(const std::vector<RigidBody*>& bodies) {
+    // Solid world bounds take part like any other static body
+    stepBodies.assign(bodies.begin(), bodies.end());
+    for (int side = 0; side < 4; side++) {
+        if (boundaryModes[side] == BoundaryMode::Solid) {
+            stepBodies.push_back(&boundaryBodies[side]);
+        }
     }
 }
 
 void Physics::checkBodyCollisions(std::vector<RigidBody*>& bodies) {
-    for (size_t i = 0; i < bodies.size(); i++) {
-        for (size_t j = i + 1; j < bodies.size(); j++) {
-            RigidBody* bodyA = bodies[i];
-            RigidBody* bodyB = bodies[j];
-            
-            // Skip if both are static
-            if (bodyA->isStaticBody() && bodyB->isStaticBody()) continue;
-            
-            Collider* colliderA = bodyA->getCollider();
-            Collider* colliderB = bodyB->getCollider();
-            
-            if (!colliderA || !colliderB) continue;
-            
-            // Handle circle-circle collisions
-            if (colliderA->getType() == ColliderType::Circle && 
-                colliderB->getType() == ColliderType::Circle) {
-                
-                Vector2D posA = bodyA->getPosition();
-                Vector2D posB = bodyB->getPosition();
-                
-                float radiusA = colliderA->getRadius();
-                float radiusB = colliderB->getRadius();
-                
-                // Calculate distance between centers
-                Vector2D delta = posB - posA;
-                float distance = delta.length();
-                float minDistance = radiusA + radiusB;
-                
-                // Check if circles are overlapping
-                if (distance < minDistance && distance > 0.0001f) {
-                    // Collision detected!
-                    
-                    // Calculate collision normal (from A to B)
-                    Vector2D normal = delta / distance;
-                    
-                    // Calculate overlap depth
-                    float overlap = minDistance - distance;
-                    
-                    // Separate the circles (push them apart)
-                    // If one is static, only move the non-static one
-                    if (bodyA->isStaticBody()) {
-                        posB = posB + normal * overlap;
-                        bodyB->setPosition(posB);
-                    } else if (bodyB->isStaticBody()) {
-                        posA = posA - normal * overlap;
-                        bodyA->setPosition(posA);
-                    } else {
-                        // Both are dynamic - separate proportionally by mass
-                        float totalMass = bodyA->getMass() + bodyB->getMass();
-                        float ratioA = bodyB->getMass() / totalMass;
-                        float ratioB = bodyA->getMass() / totalMass;
-                        
-                        posA = posA - normal * (overlap * ratioA);
-                        posB = posB + normal * (overlap * ratioB);
-                        
-                        bodyA->setPosition(posA);
-                        bodyB->setPosition(posB);
-                    }
-                    
-                    // Calculate restitution
-                    float restitution = std::min(bodyA->getRestitution(), 
-                                                bodyB->getRestitution());
-                    
-                    // Reflect velocity for body A (if not static)
-                    if (!bodyA->isStaticBody()) {
-                        Vector2D velA = bodyA->getVelocity();
-                        float velAlongNormal = velA.dot(normal * -1.0f);
-                        
-                        if (velAlongNormal < 0) {
-                            // Reflect velocity: newVel = vel - 2*(vel·normal)*normal
-                            Vector2D newVel = velA + normal * (2.0f * velAlongNormal * (1.0f + restitution) * 0.5f);
-                            bodyA->setVelocity(newVel);
-                        }
-                    }
-                    
-                    // Reflect velocity for body B (if not static)
-                    if (!bodyB->isStaticBody()) {
-                        Vector2D velB = bodyB->getVelocity();
-                        float velAlongNormal = velB.dot(normal);
-                        
-                        if (velAlongNormal < 0) {
-                            // Reflect velocity: newVel = vel - 2*(vel·normal)*normal
-                            Vector2D newVel = velB - normal * (2.0f * velAlongNormal * (1.0f + restitution) * 0.5f);
-                            bodyB->setVelocity(newVel);
-                        }
-                    }
-                }
-            }
-            // Handle circle-rectangle collisions
-            else if ((colliderA->getType() == ColliderType::Circle && 
-                      colliderB->getType() == ColliderType::Rectangle) ||
-                     (colliderA->getType() == ColliderType::Rectangle && 
-                      colliderB->getType() == ColliderType::Circle)) {
-                
-                // Determine which is circle and which is rectangle
-                RigidBody* circleBody;
-                RigidBody* rectBody;
-                Collider* circleCollider;
-                Collider* rectCollider;
-                
-                if (colliderA->getType() == ColliderType::Circle) {
-                    circleBody = bodyA;
-                    rectBody = bodyB;
-                    circleCollider = colliderA;
-                    rectCollider = colliderB;
-                } else {
-                    circleBody = bodyB;
-                    rectBody = bodyA;
-                    circleCollider = colliderB;
-                    rectCollider = colliderA;
-                }
-                
-                Vector2D circlePos = circleBody->getPosition();
-                Vector2D rectPos = rectBody->getPosition();
-                float radius = circleCollider->getRadius();
-                float rectWidth = rectCollider->getWidth();
-                float rectHeight = rectCollider->getHeight();
-                float rectAngle = rectBody->getAngle();
-                
-                // Find the closest point on the rectangle to the circle
-                float halfWidth = rectWidth / 2.0f;
-                float halfHeight = rectHeight / 2.0f;
-                
-                // Calculate the circle position relative to rectangle
-                Vector2D delta = circlePos - rectPos;
-                
-                // Rotate delta into rectangle's local space (unrotate)
-                float cosA = std::cos(-rectAngle);
-                float sinA = std::sin(-rectAngle);
-                Vector2D localDelta(
-                    delta.x * cosA - delta.y * sinA,
-                    delta.x * sinA + delta.y * cosA
-                );
-                
-                // Clamp the circle's center to the rectangle bounds in local space
-                float closestX = std::max(-halfWidth, std::min(halfWidth, localDelta.x));
-                float closestY = std::max(-halfHeight, std::min(halfHeight, localDelta.y));
-                
-                // Rotate the closest point back to world space
-                Vector2D localClosest(closestX, closestY);
-                float cosB = std::cos(rectAngle);
-                float sinB = std::sin(rectAngle);
-                Vector2D closestPoint(
-                    localClosest.x * cosB - localClosest.y * sinB + rectPos.x,
-                    localClosest.x * sinB + localClosest.y * cosB + rectPos.y
-                );
-                
-                // Calculate distance from circle center to closest point
-                Vector2D distVec = circlePos - closestPoint;
-                float distance = distVec.length();
-                
-                // Check for collision
-                if (distance < radius) {
-                    // Collision detected!
-                    
-                    // Calculate collision normal (from rect to circle)
-                    Vector2D normal;
-                    if (distance > 0.0001f) {
-                        normal = distVec / distance;
-                    } else {
-                        // Circle center is at or very close to the closest point
-                        // Use a default normal based on which edge we're closest to (in local space)
-                        Vector2D localNormal;
-                        if (std::abs(localDelta.x) > std::abs(localDelta.y)) {
-                            localNormal = Vector2D(localDelta.x > 0 ? 1.0f : -1.0f, 0.0f);
-                        } else {
-                            localNormal = Vector2D(0.0f, localDelta.y > 0 ? 1.0f : -1.0f);
-                        }
-                        // Rotate normal back to world space
-                        normal = Vector2D(
-                            localNormal.x * cosB - localNormal.y * sinB,
-                            localNormal.x * sinB + localNormal.y * cosB
-                        );
-                    }
-                    
-                    // Calculate overlap depth
-                    float overlap = radius - distance;
-                    
-                    // Separate the objects
-                    if (rectBody->isStaticBody()) {
-                        // Only move the circle
-                        circlePos = circlePos + normal * overlap;
-                        circleBody->setPosition(circlePos);
-                    } else if (circleBody->isStaticBody()) {
-                        // Only move the rectangle
-                        rectPos = rectPos - normal * overlap;
-                        rectBody->setPosition(rectPos);
-                    } else {
-                        // Both are dynamic
-                        float totalMass = circleBody->getMass() + rectBody->getMass();
-                        float circleRatio = rectBody->getMass() / totalMass;
-                        float rectRatio = circleBody->getMass() / totalMass;
-                        
-                        circlePos = circlePos + normal * (overlap * circleRatio);
-                        rectPos = rectPos - normal * (overlap * rectRatio);
-                        
-                        circleBody->setPosition(circlePos);
-                        rectBody->setPosition(rectPos);
-                    }
-                    
-                    // Calculate velocity reflection for circle (if not static)
-                    if (!circleBody->isStaticBody()) {
-                        Vector2D circleVel = circleBody->getVelocity();
-                        
-                        // Calculate velocity along collision normal
-                        float velAlongNormal = circleVel.dot(normal);
-                        
-                        // Only reflect if moving into the surface
-                        if (velAlongNormal < 0) {
-                            // Get restitution (bounciness)
-                            float restitution = std::min(circleBody->getRestitution(), 
-                                                        rectBody->getRestitution());
-                            
-                            // Reflect velocity along normal: newVel = vel - 2*(vel·normal)*normal
-                            // Multiply by restitution to control bounciness
-                            Vector2D newVel = circleVel - normal * (2.0f * velAlongNormal * (1.0f + restitution) * 0.5f);
-                            circleBody->setVelocity(newVel);
-                        }
-                    }
-                    
-                    // Handle dynamic rectangle colliding with static/dynamic circle
-                    if (!rectBody->isStaticBody()) {
-                        Vector2D rectVel = rectBody->getVelocity();
-                        
-                        // Calculate velocity along collision normal (reversed for rect)
-                        float velAlongNormal = rectVel.dot(normal * -1.0f);
-                        
-                        if (velAlongNormal < 0) {
-                            float restitution = std::min(circleBody->getRestitution(), 
-                                                        rectBody->getRestitution());
-                            
-                            Vector2D newVel = rectVel + normal * (2.0f * velAlongNormal * (1.0f + restitution) * 0.5f);
-                            rectBody->setVelocity(newVel);
-                        }
-                    }
-                }
+    frame++;
+    contactEvents.clear();
+
+    gatherStepBodies(bodies);
+
+    if (broadphaseEnabled) {
+        // Layer filtering happens inside the broadphase, before any narrowphase work.
+        // A partial step sizes its cells as the full step would, so pairs come out in the same order.
+        broadphase.build(stepBodies, partialFrame ? rollback.fullStepCellSize(*partialFrame) : 0.0f);
+        broadphase.findPairs([&](int a, int b) {
+            const SpatialGrid::Proxy& proxyA = broadphase.getProxy(a);
+            const SpatialGrid::Proxy& proxyB = broadphase.getProxy(b);
+            collidePair(proxyA.body, proxyB.body, proxyB.offset - proxyA.offset);
+        });
+    } else {
+        // Reference path: test every pair in body order (no periodic seams)
+        for (size_t i = 0; i < stepBodies.size(); i++) {
+            for (size_t j = i + 1; j < stepBodies.size(); j++) {
+                RigidBody* bodyA = stepBodies[i];
+                RigidBody* bodyB = stepBodies[j];
+                Collider* colliderA = bodyA->getCollider();
+                Collider* colliderB = bodyB->getCollider();
+                if (!colliderA || !colliderB) continue;
+                if (!Collider::shouldCollide(colliderA->getCategoryBits(), colliderA->getMaskBits(),
+                                             colliderB->getCategoryBits(), colliderB->getMaskBits())) continue;
+                // Only AABB-overlapping pairs enter the contact cache, as with the grid
+                if (!bodyA->getAABB().overlaps(bodyB->getAABB())) continue;
+                collidePair(bodyA, bodyB);
             }
         }
     }
+
+    // Pairs the broadphase no longer reports have separated
+    contactCache.evictStale(frame, [&](const ContactPair& pair) {
+        if (pair.touching && contactEventsEnabled) {
+            contactEvents.push_back(ContactEvent{ContactEventType::End, pair.bodyA, pair.bodyB,
+                                                 Vector2D(), Vector2D(), 0.0f, pair.sensor});
+        }
+    });
+}
+
+void Physics::step(std::vector<RigidBody*>& bodies, float dt) {
+    // Apply gravity and integrate all dynamic bodies
+    for (RigidBody* body : bodies) {
+        if (body->isStaticBody()) continue;
+        applyGravity(*body);
+        body->update(dt);
+        wrapPeriodic(*body);
+    }
+    checkBodyCollisions(bodies);
+    if (resimulating) return;
+
+    if (rollbackEnabled) {
+        if (rollback.isTracking(bodies)) {
+            rollback.endReplay();  // A normal step after rewind() drops the old timeline
+            rollback.record(frame, contactCache);
+        } else {
+            rollback.begin(bodies, frame, contactCache);
+        }
+    }
+    if (stateExport) stateExport->publish(bodies, frame, dt);
+}
+
+// ------------------ Rollback ------------------
+
+// Extra reach around a dirty body's path when looking for bodies it may
+// touch, for contact pushes and gravity within the step
+static const float ROLLBACK_MARGIN = 0.05f;
+
+void Physics::setRollbackEnabled(bool enabled, int historyFrames) {
+    rollbackEnabled = enabled;
+    if (historyFrames != rollback.getCapacity()) rollback.setCapacity(historyFrames);
+    rollback.clear();
+}
+
+bool Physics::rewind(unsigned targetFrame) {
+    if (!rollbackEnabled || !rollback.rewind(targetFrame, contactCache)) return false;
+    frame = targetFrame;
+    contactEvents.clear();
+    return true;
+}
+
+void Physics::resimulate(std::vector<RigidBody*>& bodies, unsigned toFrame, float dt,
+                         const std::function<void(unsigned frame)>& onFrame) {
+    bool tracked = rollbackEnabled && rollback.isTracking(bodies);
+    // Dirty tracking does not follow periodic seams, so those worlds resimulate everything
+    for (int side = 0; side < 4; side++) {
+        if (tracked && boundaryModes[side] == BoundaryMode::Periodic) rollback.markAllDirty();
+    }
+    bool eventsWereEnabled = contactEventsEnabled;
+    contactEventsEnabled = false;
+    resimulating = true;
+
+    while (frame < toFrame) {
+        if (onFrame) onFrame(frame + 1);
+
+        // Partial step while there is an old timeline to fall back on
+        const RollbackFrame* replayed = tracked ? rollback.takeReplay(frame + 1) : nullptr;
+        if (replayed && !rollback.isAllDirty()) {
+            rollback.propagateDirty(*replayed, dt, ROLLBACK_MARGIN);
+        }
+        if (replayed && !rollback.isAllDirty()) {
+            rollback.beginPartialStep(*replayed, contactCache, partialBodies);
+            partialFrame = replayed;
+            step(partialBodies, dt);
+            partialFrame = nullptr;
+            rollback.endPartialStep(*replayed, contactCache);
+        } else {
+            if (tracked) rollback.markAllDirty();
+            step(bodies, dt);
+        }
+        if (tracked) rollback.record(frame, contactCache);
+    }
+
+    if (tracked) rollback.endReplay();
+    resimulating = false;
+    contactEventsEnabled = eventsWereEnabled;
+    contactEvents.clear();
+
+    // Queries should see every body again, not the last partial step's
+    if (broadphaseEnabled) {
+        gatherStepBodies(bodies);
+        updateBroadphase(stepBodies);
+    }
+}
+
+// ------------------ Contact events ------------------
+
+void Physics::setContactEventsEnabled(bool enabled) {
+    contactEventsEnabled = enabled;
+    if (!enabled) contactEvents.clear();
+}
+
+void Physics::clearContacts() {
+    contactCache.clear();
+    contactEvents.clear();
+}
+
+void Physics::forgetBodies(const std::vector<RigidBody*>& bodies) {
+    if (bodies.empty()) return;
+    std::vector<RigidBody*> gone(bodies);
+    std::sort(gone.begin(), gone.end());
+    auto isGone = [&](const RigidBody* body) { return std::binary_search(gone.begin(), gone.end(), body); };
+
+    contactCache.removeIf([&](const ContactPair& pair) { return isGone(pair.bodyA) || isGone(pair.bodyB); });
+    contactEvents.erase(std::remove_if(contactEvents.begin(), contactEvents.end(), [&](const ContactEvent& event) {
+        return isGone(event.bodyA) || isGone(event.bodyB);
+    }), contactEvents.end());
+
+    // The history could no longer restore these bodies
+    for (RigidBody* body : gone) {
+        if (rollback.tracks(body)) {
+            rollback.clear();
+            break;
+        }
+    }
+
+    stepBodies.erase(std::remove_if(stepBodies.begin(), stepBodies.end(), isGone), stepBodies.end());
+    if (broadphaseEnabled) updateBroadphase(stepBodies);
+}
+
+// ------------------ Spatial queries ------------------
+
+static bool normalizeDirection(const Vector2D& dir, Vector2D& unit) {
+    float len = std::sqrt(dir.dot(dir));
+    if (len < 1e-12f) return false;
+    unit = dir / len;
+    return true;
+}
+
+void Physics::updateBroadphase(const std::vector<RigidBody*>& bodies) {
+    broadphase.build(bodies);
+}
+
+float Physics::clipToWorld(const Vector2D& origin, const Vector2D& dir, float maxDistance, float margin) const {
+    if (std::isfinite(maxDistance)) return maxDistance;
+
+    // Past this distance the ray has left the bounds of every body
+    const AABB& bounds = broadphase.getBounds();
+    float limit = 0.0f;
+    const float o[2] = {origin.x, origin.y};
+    const float d[2] = {dir.x, dir.y};
+    const float lo[2] = {bounds.min.x - margin, bounds.min.y - margin};
+    const float hi[2] = {bounds.max.x + margin, bounds.max.y + margin};
+    for (int axis = 0; axis < 2; axis++) {
+        if (std::abs(d[axis]) < 1e-12f) continue;
+        float t = ((d[axis] > 0 ? hi[axis] : lo[axis]) - o[axis]) / d[axis];
+        limit = std::max(limit, t);
+    }
+    return limit;
+}
+
+bool Physics::raycast(const Vector2D& origin, const Vector2D& dir, float maxDistance, RaycastHit& hit) const {
+    Vector2D unit;
+    if (!normalizeDirection(dir, unit)) return false;
+
+    hit.body = nullptr;
+    float best = maxDistance;
+    broadphase.raycast(origin, unit, maxDistance, [&](int index) {
+        // A ghost proxy stands for the body one period away, so cast from the origin shifted back
+        const SpatialGrid::Proxy& proxy = broadphase.getProxy(index);
+        RigidBody* body = proxy.body;
+        float distance;
+        Vector2D normal;
+        if (raycastBody(*body, origin - proxy.offset, unit, best, distance, normal) &&
+            (!hit.body || distance < best)) {
+            best = distance;
+            hit.body = body;
+            hit.normal = normal;
+            hit.distance = distance;
+        }
+        return best;
+    });
+
+    if (!hit.body) return false;
+    hit.point = origin + unit * hit.distance;
+    return true;
+}
+
+int Physics::raycastAll(const Vector2D& origin, const Vector2D& dir, float maxDistance,
+                        std::vector<RaycastHit>& hits) const {
+    hits.clear();
+    Vector2D unit;
+    if (!normalizeDirection(dir, unit)) return 0;
+
+    broadphase.raycast(origin, unit, maxDistance, [&](int index) {
+        const SpatialGrid::Proxy& proxy = broadphase.getProxy(index);
+        RaycastHit h;
+        h.body = proxy.body;
+        if (raycastBody(*h.body, origin - proxy.offset, unit, maxDistance, h.distance, h.normal)) {
+            h.point = origin + unit * h.distance;
+            hits.push_back(h);
+        }
+        return maxDistance;
+    });
+
+    // Bodies spanning several cells are reported once per cell, and periodic ones once
+    // per image; keep the nearest hit each
+    std::sort(hits.begin(), hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+        return a.body != b.body ? a.body < b.body : a.distance < b.distance;
+    });
+    hits.erase(std::unique(hits.begin(), hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+        return a.body == b.body;
+    }), hits.end());
+    std::sort(hits.begin(), hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+        return a.distance < b.distance;
+    });
+    return static_cast<int>(hits.size());
+}
+
+void Physics::raycastBatch(const std::vector<Ray>& rays, std::vector<RaycastHit>& hits) const {
+    hits.resize(rays.size());
+    // The grid is read-only here, so rays can be split freely across threads
+    ThreadPool::shared().parallelFor(static_cast<int>(rays.size()), 64, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            if (!raycast(rays[i].origin, rays[i].dir, rays[i].maxDistance, hits[i])) {
+                hits[i] = RaycastHit();
+            }
+        }
+    });
+}
+
+bool Physics::circleCast(const Vector2D& origin, float radius, const Vector2D& dir, float maxDistance,
+                         RaycastHit& hit) const {
+    Vector2D unit;
+    if (!normalizeDirection(dir, unit)) return false;
+    float reach = clipToWorld(origin, unit, maxDistance, radius);
+
+    // Candidates come from the AABB swept by the circle
+    Vector2D end = origin + unit * reach;
+    AABB swept{Vector2D(std::min(origin.x, end.x) - radius, std::min(origin.y, end.y) - radius),
+               Vector2D(std::max(origin.x, end.x) + radius, std::max(origin.y, end.y) + radius)};
+
+    hit.body = nullptr;
+    float best = reach;
+    broadphase.query(swept, [&](int index) {
+        const SpatialGrid::Proxy& proxy = broadphase.getProxy(index);
+        RigidBody* body = proxy.body;
+        float distance;
+        Vector2D normal;
+        if (circleCastBody(*body, origin - proxy.offset, radius, unit, best, distance, normal) &&
+            (!hit.body || distance < best)) {
+            best = distance;
+            hit.body = body;
+            hit.normal = normal;
+            hit.distance = distance;
+        }
+    });
+
+    if (!hit.body) return false;
+    // Contact point lies one radius behind the swept circle's center, against the normal
+    hit.point = origin + unit * hit.distance - hit.normal * radius;
+    return true;
+}
+
+bool Physics::boxCast(const Vector2D& origin, const Vector2D& halfExtents, float angle, const Vector2D& dir,
+                      float maxDistance, RaycastHit& hit) const {
+    Vector2D unit;
+    if (!normalizeDirection(dir, unit)) return false;
+
+    // Bounding radius of the box is enough to gather candidates
+    float extent = std::sqrt(halfExtents.dot(halfExtents));
+    float reach = clipToWorld(origin, unit, maxDistance, extent);
+    Vector2D end = origin + unit * reach;
+    AABB swept{Vector2D(std::min(origin.x, end.x) - extent, std::min(origin.y, end.y) - extent),
+               Vector2D(std::max(origin.x, end.x) + extent, std::max(origin.y, end.y) + extent)};
+
+    hit.body = nullptr;
+    float best = reach;
+    broadphase.query(swept, [&](int index) {
+        const SpatialGrid::Proxy& proxy = broadphase.getProxy(index);
+        RigidBody* body = proxy.body;
+        float distance;
+        Vector2D normal;
+        if (boxCastBody(*body, origin - proxy.offset, halfExtents, angle, unit, best, distance, normal) &&
+            (!hit.body || distance < best)) {
+            best = distance;
+            hit.body = body;
+            hit.normal = normal;
+            hit.distance = distance;
+        }
+    });
+
+    if (!hit.body) return false;
+    // Report the caster's support point pushed against the hit surface
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    Vector2D axisX(c, s), axisY(-s, c);
+    Vector2D center = origin + unit * hit.distance;
+    hit.point = center - axisX * (halfExtents.x * (hit.normal.dot(axisX) > 0 ? 1.0f : -1.0f))
+                       - axisY * (halfExtents.y * (hit.normal.dot(axisY) > 0 ? 1.0f : -1.0f));
+    return true;
+}
+
+int Physics::queryRegion(const AABB& region, std::vector<RigidBody*>& results) const {
+    results.clear();
+    broadphase.query(region, [&](int index) {
+        // Periodic bodies can overlap through several images; report each once
+        if (broadphase.firstImageIn(index, region)) results.push_back(broadphase.getProxy(index).body);
+    });
+    return static_cast<int>(results.size());
+}
+
+int Physics::queryPoint(const Vector2D& point, std::vector<RigidBody*>& results) const {
+    results.clear();
+    broadphase.query(AABB{point, point}, [&](int index) {
+        // Images lie a period apart, so at most one of a body's holds the point
+        const SpatialGrid::Proxy& proxy = broadphase.getProxy(index);
+        if (bodyContainsPoint(*proxy.body, point - proxy.offset)) results.push_back(proxy.body);
+    });
+    return static_cast<int>(results.size());
 }
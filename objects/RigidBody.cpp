@@ -1,15 +1,18 @@
 #include "RigidBody.h"
+#include "Integrator.h"
 #include "Collider.h"
 #include "Vector2D.h"
 #include <OpenGL/gl.h>
 #include <cmath>
+#include <limits>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// Initialize static member
+// Initialize static members
 float RigidBody::pixelsPerMeter = 50.0f;
+uint32_t RigidBody::nextId = 1;
 
 RigidBody::RigidBody(const Vector2D& pos, float m, bool stat)
     : position(pos),
@@ -21,7 +24,8 @@ RigidBody::RigidBody(const Vector2D& pos, float m, bool stat)
       isStatic(stat),
       angle(0.0f),
       angularV(0.0f),
-      inertia(m * 0.5f)
+      inertia(m * 0.5f),
+      id(nextId++)
 {}
 
 Vector2D RigidBody::getPosition() const { return position; }
@@ -31,16 +35,91 @@ float RigidBody::getMass() const { return mass; }
 float RigidBody::getRestitution() const { return restitution; }
 float RigidBody::getFriction() const { return friction; }
 float RigidBody::getAngle() const { return angle; }
+float RigidBody::getCosAngle() const { return cosAngle; }
+float RigidBody::getSinAngle() const { return sinAngle; }
 bool RigidBody::isStaticBody() const { return isStatic; }
 Collider* RigidBody::getCollider() const { return collider; }
+uint32_t RigidBody::getId() const { return id; }
+void RigidBody::assignNewId() { id = nextId++; }
+
+BodyState RigidBody::getState() const {
+    return BodyState{position, velocity, acceleration, angle, angularV};
+}
+
+// Half size of the world AABB of a collider rotated by (c, s)
+static Vector2D halfExtentsOf(const Collider* collider, float c, float s) {
+    if (!collider || collider->getType() == ColliderType::Plane) return Vector2D();
+    if (collider->getType() == ColliderType::Circle) {
+        float r = collider->getRadius();
+        return Vector2D(r, r);
+    }
+    // Extents of a rotated rectangle
+    float hw = collider->getWidth() / 2.0f;
+    float hh = collider->getHeight() / 2.0f;
+    c = std::abs(c);
+    s = std::abs(s);
+    return Vector2D(hw * c + hh * s, hw * s + hh * c);
+}
+
+AABB RigidBody::boundsAround(const Vector2D& at, const Vector2D& extents) const {
+    if (!collider) return AABB{at, at};
+
+    if (collider->getType() == ColliderType::Plane) {
+        // Unbounded on every side except the one the normal faces
+        const float inf = std::numeric_limits<float>::infinity();
+        Vector2D n = collider->getNormal();
+        AABB bounds{Vector2D(-inf, -inf), Vector2D(inf, inf)};
+        if (n.y == 0.0f && n.x > 0.0f) bounds.max.x = at.x;
+        if (n.y == 0.0f && n.x < 0.0f) bounds.min.x = at.x;
+        if (n.x == 0.0f && n.y > 0.0f) bounds.max.y = at.y;
+        if (n.x == 0.0f && n.y < 0.0f) bounds.min.y = at.y;
+        return bounds;
+    }
+
+    return AABB{at - extents, at + extents};
+}
+
+AABB RigidBody::getAABB() const { return boundsAround(position, halfExtents); }
+
+AABB RigidBody::getAABBAt(const BodyState& state) const {
+    // The cached extents still hold unless the snapshot is at another angle
+    if (state.angle == angle) return boundsAround(state.position, halfExtents);
+    return boundsAround(state.position, halfExtentsOf(collider, std::cos(state.angle), std::sin(state.angle)));
+}
+
+void RigidBody::refreshTransform() {
+    cosAngle = std::cos(angle);
+    sinAngle = std::sin(angle);
+    halfExtents = halfExtentsOf(collider, cosAngle, sinAngle);
+}
 
 void RigidBody::setPosition(const Vector2D& pos) { position = pos; }
 void RigidBody::setVelocity(const Vector2D& vel) { velocity = vel; }
 void RigidBody::setAcceleration(const Vector2D& acc) { acceleration = acc; }
 void RigidBody::setRestitution(float r) { restitution = r; }
 void RigidBody::setFriction(float f) { friction = f; }
-void RigidBody::setAngle(float a) { angle = a; }
-void RigidBody::setCollider(Collider* c) { collider = c; }
+void RigidBody::setStatic(bool s) { isStatic = s; }
+void RigidBody::setAngle(float a) {
+    angle = a;
+    refreshTransform();
+}
+
+void RigidBody::setCollider(Collider* c) {
+    collider = c;
+    refreshTransform();
+}
+
+void RigidBody::setState(const BodyState& state) {
+    position = state.position;
+    velocity = state.velocity;
+    acceleration = state.acceleration;
+    angularV = state.angularV;
+    // Restoring a snapshot mostly leaves the angle alone (static bodies, resets)
+    if (state.angle != angle) {
+        angle = state.angle;
+        refreshTransform();
+    }
+}
 
 void RigidBody::applyForce(const Vector2D& force) {
     if (isStatic) return;
@@ -97,6 +176,10 @@ void RigidBody::draw() const {
             break;
         }
 
+        case ColliderType::Plane:
+            // Boundaries are not drawn
+            break;
+
         default:
             // fallback (point)
             glPointSize(6.0f);
@@ -110,9 +193,8 @@ void RigidBody::draw() const {
 }
 void RigidBody::update(float dt){
     if(isStatic) return;
-    velocity += acceleration * dt;
-    position += velocity * dt;
-    angle += angularV * dt;
-    acceleration = Vector2D(0,0);
+    float oldAngle = angle;
+    integrateSemiImplicit(position, velocity, acceleration, angle, angularV, dt);
+    if (angle != oldAngle) refreshTransform();
 
 }
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include "Rollback.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+static bool sameState(const BodyState& a, const BodyState& b) {
+    return std::memcmp(&a, &b, sizeof(BodyState)) == 0;
+}
+
+static AABB merge(const AABB& a, const AABB& b) {
+    return AABB{Vector2D(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)),
+                Vector2D(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y))};
+}
+
+static AABB expand(const AABB& box, float amount) {
+    return AABB{box.min - Vector2D(amount, amount), box.max + Vector2D(amount, amount)};
+}
+
+RollbackHistory::RollbackHistory(int capacity) {
+    setCapacity(capacity);
+}
+
+void RollbackHistory::setCapacity(int frames) {
+    ring.assign(std::max(frames, 1), RollbackFrame());
+    head = 0;
+    count = 0;
+}
+
+void RollbackHistory::clear() {
+    head = 0;
+    count = 0;
+    tracked.clear();
+    lastStates.clear();
+    indexOfId.clear();
+    endReplay();
+    dirtyCount = 0;
+    allDirty = false;
+}
+
+bool RollbackHistory::isTracking(const std::vector<RigidBody*>& bodies) const {
+    return count > 0 && bodies == tracked;
+}
+
+bool RollbackHistory::tracks(const RigidBody* body) const {
+    auto it = indexOfId.find(body->getId());
+    return it != indexOfId.end() && tracked[it->second] == body;
+}
+
+void RollbackHistory::begin(const std::vector<RigidBody*>& bodies, unsigned frame, const ContactCache& cache) {
+    clear();
+    tracked = bodies;
+    lastStates.resize(tracked.size());
+    indexOfId.reserve(tracked.size());
+    for (size_t i = 0; i < tracked.size(); i++) {
+        lastStates[i] = tracked[i]->getState();
+        indexOfId[tracked[i]->getId()] = static_cast<int>(i);
+    }
+    entryOf.assign(tracked.size(), -1);
+
+    // The first frame has no changes, only the starting contacts
+    RollbackFrame& first = slot(0);
+    count = 1;
+    first.frame = frame;
+    first.changed.clear();
+    first.before.clear();
+    first.after.clear();
+    first.contacts.clear();
+    for (const ContactPair& pair : cache.getSlots()) {
+        if (pair.key != 0) first.contacts.push_back(pair);
+    }
+}
+
+void RollbackHistory::record(unsigned frame, const ContactCache& cache) {
+    if (count == static_cast<int>(ring.size())) {
+        head = (head + 1) % ring.size();
+        count--;
+    }
+
+    // Reuse the slot's buffers, so a warm ring does not allocate
+    RollbackFrame& f = slot(count);
+    count++;
+    f.frame = frame;
+    f.changed.clear();
+    f.before.clear();
+    f.after.clear();
+    f.contacts.clear();
+    for (size_t i = 0; i < tracked.size(); i++) {
+        BodyState state = tracked[i]->getState();
+        if (sameState(state, lastStates[i])) continue;
+        f.changed.push_back(static_cast<uint32_t>(i));
+        f.before.push_back(lastStates[i]);
+        f.after.push_back(state);
+        lastStates[i] = state;
+    }
+    for (const ContactPair& pair : cache.getSlots()) {
+        if (pair.key != 0) f.contacts.push_back(pair);
+    }
+}
+
+bool RollbackHistory::rewind(unsigned target, ContactCache& cache) {
+    int t = count - 1;
+    while (t >= 0 && slot(t).frame != target) t--;
+    if (t < 0) return false;
+
+    // Undo newest first; the undone frames become the replay, oldest first
+    endReplay();
+    for (int i = count - 1; i > t; i--) {
+        const RollbackFrame& f = slot(i);
+        for (size_t e = 0; e < f.changed.size(); e++) {
+            tracked[f.changed[e]]->setState(f.before[e]);
+            lastStates[f.changed[e]] = f.before[e];
+        }
+    }
+    // Swap rather than move, so the ring gets the last replay's buffers back
+    for (int i = t + 1; i < count; i++) {
+        if (replayCount == replay.size()) replay.emplace_back();
+        std::swap(replay[replayCount++], slot(i));
+    }
+    count = t + 1;
+
+    cache.clear();
+    for (const ContactPair& pair : slot(t).contacts) {
+        cache.insert(pair);
+    }
+
+    shadow = lastStates;
+    dirty.assign(tracked.size(), 0);
+    dirtyCount = 0;
+    allDirty = false;
+    return true;
+}
+
+// ------------------ Resimulation ------------------
+
+const RollbackFrame* RollbackHistory::takeReplay(unsigned frame) {
+    if (replayNext >= replayCount || replay[replayNext].frame != frame) return nullptr;
+    return &replay[replayNext++];
+}
+
+void RollbackHistory::endReplay() {
+    // The dirty count stays readable until the next rewind
+    replayCount = 0;
+    replayNext = 0;
+    shadow.clear();
+    dirty.clear();
+}
+
+void RollbackHistory::markDirty(const RigidBody* body) {
+    auto it = indexOfId.find(body->getId());
+    if (it == indexOfId.end() || dirty.empty()) return;
+    if (tracked[it->second]->isStaticBody() || dirty[it->second]) return;
+    dirty[it->second] = 1;
+    dirtyCount++;
+}
+
+// A dirty body further than this from its old path has really been affected;
+// closer ones are snapped back onto the old path once nothing pushes them
+static const float DIVERGED_DISTANCE = 1e-4f;
+static const float DIVERGED_SPEED = 1e-3f;
+static const float DIVERGED_ANGLE = 1e-3f;
+
+static bool hasDiverged(const BodyState& a, const BodyState& b) {
+    return (a.position - b.position).length() > DIVERGED_DISTANCE ||
+           (a.velocity - b.velocity).length() > DIVERGED_SPEED ||
+           (a.acceleration - b.acceleration).length() > DIVERGED_SPEED ||
+           std::abs(a.angle - b.angle) > DIVERGED_ANGLE ||
+           std::abs(a.angularV - b.angularV) > DIVERGED_ANGLE;
+}
+
+AABB RollbackHistory::pathBounds(int index, const RollbackFrame& next, float dt, float margin) const {
+    // Old and new paths both count: the replayed bodies reacted to the old one
+    const RigidBody* body = tracked[index];
+    AABB path = body->getAABB();
+    if (dirty[index]) path = merge(path, body->getAABBAt(shadow[index]));
+    if (entryOf[index] >= 0) path = merge(path, body->getAABBAt(next.after[entryOf[index]]));
+    float speed = std::max(body->getVelocity().length(), shadow[index].velocity.length());
+    return expand(path, speed * dt + margin);
+}
+
+void RollbackHistory::propagateDirty(const RollbackFrame& next, float dt, float margin) {
+    border.clear();
+    if (dirtyCount == 0) return;  // Pure replay
+
+    for (size_t e = 0; e < next.changed.size(); e++) {
+        entryOf[next.changed[e]] = static_cast<int>(e);
+    }
+
+    // Grid over the dynamic bodies at their current state
+    gridBodies.clear();
+    gridIndex.clear();
+    int dynamicCount = 0;
+    for (size_t i = 0; i < tracked.size(); i++) {
+        if (tracked[i]->isStaticBody()) continue;
+        dynamicCount++;
+        if (!tracked[i]->getCollider()) continue;  // The grid skips bodies without colliders
+        gridBodies.push_back(tracked[i]);
+        gridIndex.push_back(static_cast<int>(i));
+    }
+    // A few dirty bodies are cheaper to check against every body than to grid
+    bool useGrid = false;
+    auto forCandidates = [&](const AABB& region, auto&& visit) {
+        if (!useGrid && worklist.size() + border.size() > 16) {
+            grid.build(gridBodies);
+            useGrid = true;
+        }
+        if (useGrid) {
+            grid.query(region, [&](int proxy) { visit(gridIndex[proxy]); });
+        } else {
+            for (size_t p = 0; p < gridBodies.size(); p++) {
+                if (gridBodies[p]->getAABB().overlaps(region)) visit(gridIndex[p]);
+            }
+        }
+    };
+
+    // Furthest a proxy's path can reach past its current box: the replayed
+    // move, box growth from rotation, and the pathBounds expansion
+    float slack = 0.0f;
+    float maxSpeed = 0.0f;
+    for (size_t e = 0; e < next.changed.size(); e++) {
+        int i = next.changed[e];
+        Vector2D move = next.after[e].position - next.before[e].position;
+        float growth = 0.0f;
+        if (next.after[e].angle != next.before[e].angle) {
+            AABB box = tracked[i]->getAABB();
+            growth = (box.max - box.min).length() * 0.5f;
+        }
+        slack = std::max(slack, move.length() + growth);
+    }
+    for (int i : gridIndex) {
+        maxSpeed = std::max({maxSpeed, tracked[i]->getVelocity().length(), shadow[i].velocity.length()});
+    }
+    slack += maxSpeed * dt + margin;
+
+    worklist.clear();
+    // Whatever a diverged body may touch is affected, and so on through the
+    // bodies it reaches (a pile is one island, as the solver sees it). Dirty
+    // bodies nothing diverged reaches are back on their old path and rejoin
+    // the replay.
+    for (size_t i = 0; i < tracked.size(); i++) {
+        if (dirty[i] && hasDiverged(tracked[i]->getState(), shadow[i])) worklist.push_back(static_cast<int>(i));
+    }
+    touched.assign(tracked.size(), 0);
+    for (int i : worklist) touched[i] = 1;
+    int reached = static_cast<int>(worklist.size());
+    for (size_t w = 0; w < worklist.size() && reached * 4 <= dynamicCount; w++) {
+        AABB reach = pathBounds(worklist[w], next, dt, margin);
+        forCandidates(expand(reach, slack), [&](int j) {
+            if (touched[j] || !pathBounds(j, next, dt, margin).overlaps(reach)) return;
+            touched[j] = 1;
+            worklist.push_back(j);
+            reached++;
+        });
+    }
+    if (reached * 4 > dynamicCount) {
+        // Past a quarter of the bodies, stepping everything is cheaper than tracking
+        allDirty = true;
+        worklist.clear();
+        for (uint32_t i : next.changed) entryOf[i] = -1;
+        return;
+    }
+    for (int i : worklist) {
+        if (!dirty[i]) {
+            dirty[i] = 1;
+            dirtyCount++;
+        }
+    }
+    worklist.clear();
+    for (size_t i = 0; i < tracked.size(); i++) {
+        if (dirty[i] && !touched[i]) {
+            tracked[i]->setState(shadow[i]);
+            dirty[i] = 0;
+            dirtyCount--;
+        }
+    }
+
+    // Clean bodies a dirty one may hit are stepped too, as ghosts: the dirty
+    // body gets the right mass-weighted response, then they go back to the replay
+    for (size_t i = 0; i < tracked.size(); i++) {
+        if (!dirty[i] || !tracked[i]->getCollider()) continue;
+        AABB reach = pathBounds(static_cast<int>(i), next, dt, margin);
+        forCandidates(expand(reach, slack), [&](int j) {
+            if (dirty[j] || touched[j] == 2 || !pathBounds(j, next, dt, margin).overlaps(reach)) return;
+            touched[j] = 2;
+            border.push_back(j);
+        });
+    }
+
+    for (uint32_t i : next.changed) entryOf[i] = -1;
+}
+
+void RollbackHistory::beginPartialStep(const RollbackFrame& next, ContactCache& cache,
+                                       std::vector<RigidBody*>& out) const {
+    out.clear();
+    for (size_t i = 0; i < tracked.size(); i++) {
+        if (dirty[i] || tracked[i]->isStaticBody()) out.push_back(tracked[i]);
+    }
+    for (int j : border) out.push_back(tracked[j]);
+
+    // Replayed pairs between clean (or untracked, e.g. boundary) bodies go in
+    // first, already marked as seen, so the step neither evicts nor redoes them
+    for (const ContactPair& pair : next.contacts) {
+        if (!isDirty(pair.bodyA) && !isDirty(pair.bodyB)) cache.insert(pair);
+    }
+}
+
+void RollbackHistory::endPartialStep(const RollbackFrame& next, ContactCache& cache) {
+    for (size_t e = 0; e < next.changed.size(); e++) {
+        int i = next.changed[e];
+        shadow[i] = next.after[e];
+        if (!dirty[i]) tracked[i]->setState(next.after[e]);
+    }
+
+    // Ghost results are discarded, pairs between ghosts included
+    if (border.empty()) return;
+    for (int j : border) tracked[j]->setState(shadow[j]);
+    for (const ContactPair& pair : next.contacts) {
+        if ((isBorder(pair.bodyA) || isBorder(pair.bodyB)) && !isDirty(pair.bodyA) && !isDirty(pair.bodyB)) {
+            cache.insert(pair);
+        }
+    }
+}
+
+float RollbackHistory::fullStepCellSize(const RollbackFrame& next) {
+    // Pure replay steps only the static bodies, which cannot pair with each other
+    if (dirtyCount == 0) return 0.0f;
+
+    // Stepped bodies are already where the full step would have them; clean
+    // ones are not moved until endPartialStep, so take their replayed extents
+    sizes.clear();
+    for (size_t i = 0; i < tracked.size(); i++) {
+        sizes.push_back(0.0f);
+        if (!tracked[i]->getCollider()) {
+            sizes.back() = std::numeric_limits<float>::infinity();  // Not in the grid
+            continue;
+        }
+        AABB box = tracked[i]->getAABB();
+        Vector2D extent = box.max - box.min;
+        sizes.back() = std::max(extent.x, extent.y);
+    }
+    for (size_t e = 0; e < next.changed.size(); e++) {
+        int i = next.changed[e];
+        if (dirty[i] || touched[i] == 2 || !tracked[i]->getCollider()) continue;
+        AABB box = tracked[i]->getAABBAt(next.after[e]);
+        Vector2D extent = box.max - box.min;
+        sizes[i] = std::max(extent.x, extent.y);
+    }
+    return SpatialGrid::autoCellSize(sizes);
+}
+
+bool RollbackHistory::isDirty(const RigidBody* body) const {
+    if (dirtyCount == 0) return false;
+    auto it = indexOfId.find(body->getId());
+    return it != indexOfId.end() && dirty[it->second];
+}
+
+bool RollbackHistory::isBorder(const RigidBody* body) const {
+    auto it = indexOfId.find(body->getId());
+    return it != indexOfId.end() && touched[it->second] == 2;
+}
@@ -0,0 +1,506 @@
+#include "SceneFile.h"
+#include "CircleCollider.h"
+#include "RectangleCollider.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char SCENE_MAGIC[4] = {'S', 'C', 'N', '1'};
+static const uint32_t SCENE_VERSION = 1;
+
+// The compiled form is these structs written raw, so their layout is the format
+static_assert(sizeof(SceneSettings) == 40, "scene settings layout changed");
+static_assert(sizeof(SceneMaterial) == 40, "scene material layout changed");
+static_assert(sizeof(SceneShape) == 52, "scene shape layout changed");
+static_assert(sizeof(SceneBody) == 36, "scene body layout changed");
+static_assert(sizeof(SceneSpawner) == 56, "scene spawner layout changed");
+
+// ------------------ Text parsing helpers ------------------
+
+// Splits a line into whitespace-separated tokens in place, stopping at '#'
+static int tokenize(char* line, char** tokens, int maxTokens) {
+    int count = 0;
+    char* p = line;
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (*p == '\0' || *p == '#') break;
+        if (count == maxTokens) return -1;
+        tokens[count++] = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' && *p != '#') p++;
+        if (*p == '#') {
+            *p = '\0';
+            break;
+        }
+        if (*p) *p++ = '\0';
+    }
+    return count;
+}
+
+// Rejects nan, inf and values out of float range, which would reach the solver as is
+static bool parseFloat(const char* token, float& value) {
+    char* end;
+    value = std::strtof(token, &end);
+    return end != token && *end == '\0' && std::isfinite(value);
+}
+
+static bool parseUnsigned(const char* token, unsigned long long& value) {
+    char* end;
+    value = std::strtoull(token, &end, 0);
+    return end != token && *end == '\0' && token[0] != '-';
+}
+
+static bool parseBoundaryMode(const char* token, uint8_t& mode) {
+    if (std::strcmp(token, "solid") == 0) mode = static_cast<uint8_t>(BoundaryMode::Solid);
+    else if (std::strcmp(token, "open") == 0) mode = static_cast<uint8_t>(BoundaryMode::Open);
+    else if (std::strcmp(token, "periodic") == 0) mode = static_cast<uint8_t>(BoundaryMode::Periodic);
+    else return false;
+    return true;
+}
+
+static bool copyName(const char* token, char (&name)[32]) {
+    if (std::strlen(token) >= sizeof(name)) return false;
+    std::memset(name, 0, sizeof(name));
+    std::strcpy(name, token);
+    return true;
+}
+
+// SceneTemplate::randomize rejects a minimum above its maximum, so catch it at load
+static bool finite(const Vector2D& v) {
+    return std::isfinite(v.x) && std::isfinite(v.y);
+}
+
+static bool rangesOrdered(const SceneSpawner& spawner) {
+    return spawner.minPosition.x <= spawner.maxPosition.x && spawner.minPosition.y <= spawner.maxPosition.y &&
+           spawner.minAngle <= spawner.maxAngle &&
+           spawner.minVelocity.x <= spawner.maxVelocity.x && spawner.minVelocity.y <= spawner.maxVelocity.y;
+}
+
+// ------------------ SceneFile ------------------
+
+void SceneFile::clear() {
+    settings = SceneSettings();
+    materials.clear();
+    shapes.clear();
+    bodies.clear();
+    spawners.clear();
+    colliders.clear();
+}
+
+int SceneFile::findMaterial(const char* name) const {
+    for (size_t i = 0; i < materials.size(); i++) {
+        if (std::strcmp(materials[i].name, name) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int SceneFile::findShape(const char* name) const {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        if (std::strcmp(shapes[i].name, name) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int SceneFile::getBodyCount() const {
+    size_t count = bodies.size();
+    for (const SceneSpawner& spawner : spawners) count += spawner.count;
+    return static_cast<int>(count);
+}
+
+bool SceneFile::load(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::perror(path);
+        clear();
+        return false;
+    }
+    char magic[4] = {0, 0, 0, 0};
+    size_t got = std::fread(magic, 1, sizeof(magic), file);
+    std::fclose(file);
+    if (got == sizeof(magic) && std::memcmp(magic, SCENE_MAGIC, sizeof(magic)) == 0) {
+        return loadCompiled(path);
+    }
+    return loadText(path);
+}
+
+bool SceneFile::loadText(const char* path) {
+    clear();
+    FILE* file = std::fopen(path, "r");
+    if (!file) {
+        std::perror(path);
+        return false;
+    }
+
+    // One fixed line buffer; records are the only thing that grows
+    char line[1024];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && std::fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        if (!std::strchr(line, '\n') && !std::feof(file)) {
+            std::fprintf(stderr, "%s:%d: line too long\n", path, lineNumber);
+            ok = false;
+            break;
+        }
+        ok = parseLine(line, path, lineNumber);
+    }
+    std::fclose(file);
+    if (ok) createColliders();
+    else clear();
+    return ok;
+}
+
+bool SceneFile::parseLine(char* line, const char* path, int lineNumber) {
+    char* t[24];
+    int n = tokenize(line, t, 24);
+    if (n == 0) return true;
+
+    // Reports the error for this line and fails the load
+    auto fail = [&](const char* message) {
+        std::fprintf(stderr, "%s:%d: %s\n", path, lineNumber, message);
+        return false;
+    };
+    if (n < 0) return fail("too many fields");
+
+    const char* keyword = t[0];
+    unsigned long long whole;
+
+    // ------------------ World settings ------------------
+    if (std::strcmp(keyword, "world") == 0) {
+        if (n != 3 || !parseFloat(t[1], settings.width) || !parseFloat(t[2], settings.height) ||
+            settings.width <= 0.0f || settings.height <= 0.0f) {
+            return fail("expected: world <width> <height>");
+        }
+        return true;
+    }
+    if (std::strcmp(keyword, "gravity") == 0) {
+        if (n != 3 || !parseFloat(t[1], settings.gravity.x) || !parseFloat(t[2], settings.gravity.y)) {
+            return fail("expected: gravity <x> <y>");
+        }
+        return true;
+    }
+    if (std::strcmp(keyword, "boundary") == 0) {
+        static const char* sides[4] = {"left", "right", "bottom", "top"};
+        uint8_t mode;
+        if (n != 3 || !parseBoundaryMode(t[2], mode)) {
+            return fail("expected: boundary <left|right|bottom|top|all> <solid|open|periodic>");
+        }
+        bool all = std::strcmp(t[1], "all") == 0;
+        bool matched = all;
+        for (int side = 0; side < 4; side++) {
+            if (all || std::strcmp(t[1], sides[side]) == 0) {
+                settings.boundaries[side] = mode;
+                matched = true;
+            }
+        }
+        if (!matched) return fail("unknown boundary side");
+        return true;
+    }
+    if (std::strcmp(keyword, "broadphase") == 0) {
+        if (n == 2 && std::strcmp(t[1], "on") == 0) settings.broadphase = 1;
+        else if (n == 2 && std::strcmp(t[1], "off") == 0) settings.broadphase = 0;
+        else return fail("expected: broadphase <on|off>");
+        return true;
+    }
+    if (std::strcmp(keyword, "timestep") == 0) {
+        if (n != 2 || !parseFloat(t[1], settings.timestep) || settings.timestep <= 0.0f) {
+            return fail("expected: timestep <seconds>");
+        }
+        return true;
+    }
+    if (std::strcmp(keyword, "seed") == 0) {
+        if (n != 2 || !parseUnsigned(t[1], whole)) return fail("expected: seed <n>");
+        settings.seed = whole;
+        settings.hasSeed = 1;
+        return true;
+    }
+
+    // ------------------ Materials and shapes ------------------
+    if (std::strcmp(keyword, "material") == 0) {
+        SceneMaterial material;
+        if (n != 4 || !parseFloat(t[2], material.restitution) || !parseFloat(t[3], material.friction)) {
+            return fail("expected: material <name> <restitution> <friction>");
+        }
+        if (!copyName(t[1], material.name)) return fail("name longer than 31 characters");
+        if (findMaterial(material.name) >= 0) return fail("material already defined");
+        materials.push_back(material);
+        return true;
+    }
+    if (std::strcmp(keyword, "circle") == 0 || std::strcmp(keyword, "rect") == 0) {
+        bool circle = keyword[0] == 'c';
+        int fixed = circle ? 3 : 4;
+        SceneShape shape;
+        shape.type = static_cast<uint32_t>(circle ? ColliderType::Circle : ColliderType::Rectangle);
+        shape.height = 0.0f;
+        shape.category = 0x0001;
+        shape.mask = 0xFFFF;
+        shape.sensor = 0;
+        if (n < fixed || !parseFloat(t[2], shape.width) || shape.width <= 0.0f ||
+            (!circle && (!parseFloat(t[3], shape.height) || shape.height <= 0.0f))) {
+            return fail(circle ? "expected: circle <name> <radius>" : "expected: rect <name> <width> <height>");
+        }
+        for (int i = fixed; i < n; i++) {
+            unsigned long long category, mask;
+            if (std::strcmp(t[i], "sensor") == 0) {
+                shape.sensor = 1;
+            } else if (std::strcmp(t[i], "filter") == 0 && i + 2 < n &&
+                       parseUnsigned(t[i + 1], category) && parseUnsigned(t[i + 2], mask) &&
+                       category <= 0xFFFF && mask <= 0xFFFF) {
+                shape.category = static_cast<uint16_t>(category);
+                shape.mask = static_cast<uint16_t>(mask);
+                i += 2;
+            } else {
+                return fail("unknown shape option");
+            }
+        }
+        if (!copyName(t[1], shape.name)) return fail("name longer than 31 characters");
+        if (findShape(shape.name) >= 0) return fail("shape already defined");
+        shapes.push_back(shape);
+        return true;
+    }
+
+    // ------------------ Bodies and spawners ------------------
+    if (std::strcmp(keyword, "body") == 0 || std::strcmp(keyword, "spawn") == 0) {
+        bool spawn = keyword[0] == 's';
+        if (n < 3) return fail(spawn ? "expected: spawn <shape> <material> ..." : "expected: body <shape> <material> ...");
+        int shape = findShape(t[1]);
+        int material = findMaterial(t[2]);
+        if (shape < 0) return fail("unknown shape");
+        if (material < 0) return fail("unknown material");
+
+        if (!spawn) {
+            SceneBody body{static_cast<uint32_t>(shape), static_cast<uint32_t>(material),
+                           Vector2D(), Vector2D(), 0.0f, 1.0f, 0};
+            if (n < 5 || !parseFloat(t[3], body.position.x) || !parseFloat(t[4], body.position.y)) {
+                return fail("expected: body <shape> <material> <x> <y>");
+            }
+            for (int i = 5; i < n; i++) {
+                if (std::strcmp(t[i], "static") == 0) {
+                    body.isStatic = 1;
+                } else if (std::strcmp(t[i], "mass") == 0 && i + 1 < n && parseFloat(t[i + 1], body.mass) &&
+                           body.mass > 0.0f) {
+                    i += 1;
+                } else if (std::strcmp(t[i], "angle") == 0 && i + 1 < n && parseFloat(t[i + 1], body.angle)) {
+                    i += 1;
+                } else if (std::strcmp(t[i], "velocity") == 0 && i + 2 < n &&
+                           parseFloat(t[i + 1], body.velocity.x) && parseFloat(t[i + 2], body.velocity.y)) {
+                    i += 2;
+                } else {
+                    return fail("unknown or incomplete body option");
+                }
+            }
+            bodies.push_back(body);
+            return true;
+        }
+
+        SceneSpawner spawner{static_cast<uint32_t>(shape), static_cast<uint32_t>(material), 0, 1.0f,
+                             Vector2D(), Vector2D(), 0.0f, 0.0f, Vector2D(), Vector2D()};
+        if (n < 8 || !parseUnsigned(t[3], whole) || whole == 0 || whole > 0x7FFFFFFF ||
+            !parseFloat(t[4], spawner.minPosition.x) || !parseFloat(t[5], spawner.minPosition.y) ||
+            !parseFloat(t[6], spawner.maxPosition.x) || !parseFloat(t[7], spawner.maxPosition.y)) {
+            return fail("expected: spawn <shape> <material> <count> <minX> <minY> <maxX> <maxY>");
+        }
+        spawner.count = static_cast<uint32_t>(whole);
+        for (int i = 8; i < n; i++) {
+            if (std::strcmp(t[i], "mass") == 0 && i + 1 < n && parseFloat(t[i + 1], spawner.mass) &&
+                spawner.mass > 0.0f) {
+                i += 1;
+            } else if (std::strcmp(t[i], "angle") == 0 && i + 2 < n &&
+                       parseFloat(t[i + 1], spawner.minAngle) && parseFloat(t[i + 2], spawner.maxAngle)) {
+                i += 2;
+            } else if (std::strcmp(t[i], "velocity") == 0 && i + 4 < n &&
+                       parseFloat(t[i + 1], spawner.minVelocity.x) && parseFloat(t[i + 2], spawner.minVelocity.y) &&
+                       parseFloat(t[i + 3], spawner.maxVelocity.x) && parseFloat(t[i + 4], spawner.maxVelocity.y)) {
+                i += 4;
+            } else {
+                return fail("unknown or incomplete spawn option");
+            }
+        }
+        if (!rangesOrdered(spawner)) return fail("spawn minimum is greater than its maximum");
+        if (static_cast<unsigned long long>(getBodyCount()) + spawner.count > 0x7FFFFFFF) {
+            return fail("too many bodies");
+        }
+        spawners.push_back(spawner);
+        return true;
+    }
+
+    if (std::strcmp(keyword, "joint") == 0) return fail("joints are not supported by the engine yet");
+    return fail("unknown statement");
+}
+
+// ------------------ Compiled form ------------------
+
+template<typename T>
+static bool writeArray(FILE* file, const std::vector<T>& values) {
+    return values.empty() || std::fwrite(values.data(), sizeof(T), values.size(), file) == values.size();
+}
+
+template<typename T>
+static bool readArray(FILE* file, std::vector<T>& values, uint32_t count) {
+    values.resize(count);
+    return count == 0 || std::fread(values.data(), sizeof(T), count, file) == count;
+}
+
+bool SceneFile::saveCompiled(const char* path) const {
+    FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        std::perror(path);
+        return false;
+    }
+    const uint32_t counts[4] = {static_cast<uint32_t>(materials.size()), static_cast<uint32_t>(shapes.size()),
+                                static_cast<uint32_t>(bodies.size()), static_cast<uint32_t>(spawners.size())};
+    bool ok = std::fwrite(SCENE_MAGIC, sizeof(SCENE_MAGIC), 1, file) == 1 &&
+              std::fwrite(&SCENE_VERSION, sizeof(SCENE_VERSION), 1, file) == 1 &&
+              std::fwrite(&settings, sizeof(settings), 1, file) == 1 &&
+              std::fwrite(counts, sizeof(counts), 1, file) == 1 &&
+              writeArray(file, materials) && writeArray(file, shapes) &&
+              writeArray(file, bodies) && writeArray(file, spawners);
+    if (std::fclose(file) != 0) ok = false;
+    if (!ok) std::fprintf(stderr, "%s: write failed\n", path);
+    return ok;
+}
+
+bool SceneFile::loadCompiled(const char* path) {
+    clear();
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::perror(path);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t counts[4];
+    bool ok = std::fread(magic, sizeof(magic), 1, file) == 1 && std::memcmp(magic, SCENE_MAGIC, sizeof(magic)) == 0 &&
+              std::fread(&version, sizeof(version), 1, file) == 1 && version == SCENE_VERSION &&
+              std::fread(&settings, sizeof(settings), 1, file) == 1 &&
+              std::fread(counts, sizeof(counts), 1, file) == 1;
+
+    // Size the arrays from the header only if the file is really that long
+    if (ok) {
+        long start = std::ftell(file);
+        std::fseek(file, 0, SEEK_END);
+        unsigned long long expected = static_cast<unsigned long long>(counts[0]) * sizeof(SceneMaterial) +
+                                      static_cast<unsigned long long>(counts[1]) * sizeof(SceneShape) +
+                                      static_cast<unsigned long long>(counts[2]) * sizeof(SceneBody) +
+                                      static_cast<unsigned long long>(counts[3]) * sizeof(SceneSpawner);
+        ok = static_cast<unsigned long long>(std::ftell(file) - start) == expected;
+        std::fseek(file, start, SEEK_SET);
+    }
+    ok = ok && readArray(file, materials, counts[0]) && readArray(file, shapes, counts[1]) &&
+         readArray(file, bodies, counts[2]) && readArray(file, spawners, counts[3]);
+    std::fclose(file);
+
+    // build() trusts the records, so hold them to what the text parser accepts.
+    // Comparisons are written so that NaN fails them; infinities are ruled out too.
+    if (ok) {
+        ok = settings.width > 0.0f && settings.height > 0.0f && settings.timestep > 0.0f &&
+             std::isfinite(settings.width) && std::isfinite(settings.height) &&
+             std::isfinite(settings.timestep) && finite(settings.gravity);
+        for (int side = 0; side < 4; side++) {
+            ok = ok && settings.boundaries[side] <= static_cast<uint8_t>(BoundaryMode::Periodic);
+        }
+        for (const SceneMaterial& material : materials) {
+            ok = ok && std::memchr(material.name, '\0', sizeof(material.name)) != nullptr &&
+                 std::isfinite(material.restitution) && std::isfinite(material.friction);
+        }
+        for (const SceneShape& shape : shapes) {
+            bool circle = shape.type == static_cast<uint32_t>(ColliderType::Circle);
+            ok = ok && std::memchr(shape.name, '\0', sizeof(shape.name)) != nullptr &&
+                 (circle || shape.type == static_cast<uint32_t>(ColliderType::Rectangle)) &&
+                 shape.width > 0.0f && std::isfinite(shape.width) &&
+                 (circle || (shape.height > 0.0f && std::isfinite(shape.height)));
+        }
+        unsigned long long total = bodies.size();
+        for (const SceneBody& body : bodies) {
+            ok = ok && body.shape < shapes.size() && body.material < materials.size() && body.mass > 0.0f &&
+                 std::isfinite(body.mass) && std::isfinite(body.angle) && finite(body.position) &&
+                 finite(body.velocity);
+        }
+        for (const SceneSpawner& spawner : spawners) {
+            ok = ok && spawner.shape < shapes.size() && spawner.material < materials.size() &&
+                 spawner.count > 0 && spawner.mass > 0.0f && std::isfinite(spawner.mass) &&
+                 finite(spawner.minPosition) && finite(spawner.maxPosition) && std::isfinite(spawner.minAngle) &&
+                 std::isfinite(spawner.maxAngle) && finite(spawner.minVelocity) && finite(spawner.maxVelocity) &&
+                 rangesOrdered(spawner);
+            total += spawner.count;
+        }
+        ok = ok && total <= 0x7FFFFFFF;
+    }
+    if (ok) {
+        createColliders();
+    } else {
+        std::fprintf(stderr, "%s: not a valid compiled scene\n", path);
+        clear();
+    }
+    return ok;
+}
+
+// ------------------ Instantiation ------------------
+
+void SceneFile::configure(Physics& physics) const {
+    static const BoundarySide sides[4] = {BoundarySide::Left, BoundarySide::Right,
+                                          BoundarySide::Bottom, BoundarySide::Top};
+    for (int side = 0; side < 4; side++) {
+        physics.setBoundary(sides[side], static_cast<BoundaryMode>(settings.boundaries[side]));
+    }
+    physics.setBroadphaseEnabled(settings.broadphase != 0);
+}
+
+// One collider per shape, shared by every body using it. Made once per load,
+// so templates built earlier keep valid pointers.
+void SceneFile::createColliders() {
+    colliders.clear();
+    colliders.reserve(shapes.size());
+    for (const SceneShape& shape : shapes) {
+        Collider* collider;
+        if (shape.type == static_cast<uint32_t>(ColliderType::Circle)) {
+            collider = new CircleCollider(shape.width);
+        } else {
+            collider = new RectangleCollider(shape.width, shape.height);
+        }
+        collider->setFilter(shape.category, shape.mask);
+        collider->setSensor(shape.sensor != 0);
+        colliders.emplace_back(collider);
+    }
+}
+
+bool SceneFile::build(SceneTemplate& scene) const {
+    scene.reserve(scene.getBodyCount() + getBodyCount());
+    for (const SceneBody& record : bodies) {
+        const SceneMaterial& material = materials[record.material];
+        RigidBody body(record.position, record.mass, record.isStatic != 0);
+        body.setCollider(colliders[record.shape].get());
+        body.setRestitution(material.restitution);
+        body.setFriction(material.friction);
+        body.setAngle(record.angle);
+        body.setVelocity(record.velocity);
+        scene.addBody(body);
+    }
+
+    for (const SceneSpawner& spawner : spawners) {
+        const SceneMaterial& material = materials[spawner.material];
+        RigidBody body(spawner.minPosition, spawner.mass, false);
+        body.setCollider(colliders[spawner.shape].get());
+        body.setRestitution(material.restitution);
+        body.setFriction(material.friction);
+        body.setAngle(spawner.minAngle);
+        body.setVelocity(spawner.minVelocity);
+
+        int count = static_cast<int>(spawner.count);
+        int first = scene.addBodies(body, count);
+        if (!scene.randomize(RandomField::Position, first, count, spawner.minPosition, spawner.maxPosition)) {
+            return false;
+        }
+        if (spawner.maxAngle != spawner.minAngle &&
+            !scene.randomize(RandomField::Angle, first, count, Vector2D(spawner.minAngle, 0),
+                             Vector2D(spawner.maxAngle, 0))) {
+            return false;
+        }
+        if ((spawner.maxVelocity.x != spawner.minVelocity.x || spawner.maxVelocity.y != spawner.minVelocity.y) &&
+            !scene.randomize(RandomField::Velocity, first, count, spawner.minVelocity, spawner.maxVelocity)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#include "SceneTemplate.h"
+#include "Random.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+
+int SceneTemplate::addBody(const RigidBody& body) {
+    return addBodies(body, 1);
+}
+
+int SceneTemplate::addBodies(const RigidBody& body, int count) {
+    int first = static_cast<int>(prototypes.size());
+    prototypes.insert(prototypes.end(), count, body);
+    // Every copy is a separate body as far as contact caches are concerned
+    for (int i = first; i < first + count; i++) {
+        prototypes[i].assignNewId();
+    }
+    compiled = false;
+    return first;
+}
+
+bool SceneTemplate::randomize(RandomField field, int first, int count,
+                              const Vector2D& minValue, const Vector2D& maxValue) {
+    // reset() indexes bodies straight from the range, so it has to be valid now
+    if (first < 0 || count < 0 || count > static_cast<int>(prototypes.size()) - first) {
+        std::fprintf(stderr, "SceneTemplate::randomize: bodies [%d, %d) out of range (%d bodies)\n",
+                     first, first + count, static_cast<int>(prototypes.size()));
+        return false;
+    }
+    bool usesY = field != RandomField::Angle;
+    if (minValue.x > maxValue.x || (usesY && minValue.y > maxValue.y)) {
+        std::fprintf(stderr, "SceneTemplate::randomize: min is greater than max\n");
+        return false;
+    }
+    randomizers.push_back(Randomizer{field, first, count, minValue, maxValue});
+    return true;
+}
+
+void SceneTemplate::compile() {
+    // Snapshot every prototype into one contiguous image
+    image.resize(prototypes.size());
+    for (size_t i = 0; i < prototypes.size(); i++) {
+        image[i] = prototypes[i].getState();
+    }
+    compiled = true;
+}
+
+void SceneTemplate::instantiate(std::vector<RigidBody>& bodies, uint64_t seed) const {
+    assert(compiled && "SceneTemplate::compile() must be called first");
+    bodies = prototypes;
+    reset(bodies, seed);
+}
+
+void SceneTemplate::reset(std::vector<RigidBody>& bodies, uint64_t seed) const {
+    assert(compiled && bodies.size() == image.size());
+
+    // Copy the flat initial-state image back over the bodies
+    const BodyState* src = image.data();
+    for (size_t i = 0; i < bodies.size(); i++) {
+        bodies[i].setState(src[i]);
+    }
+
+    // Re-roll randomized fields. The counter is derived from the body index,
+    // so each body gets the same values for a seed no matter what else changed.
+    for (const Randomizer& r : randomizers) {
+        Vector2D range = r.maxValue - r.minValue;
+        for (int i = r.first; i < r.first + r.count; i++) {
+            uint64_t counter = (static_cast<uint64_t>(i) << 3) | (static_cast<uint64_t>(r.field) << 1);
+            float u = counterUniform(seed, counter);
+            float v = counterUniform(seed, counter | 1);
+
+            RigidBody& body = bodies[i];
+            switch (r.field) {
+                case RandomField::Position:
+                    body.setPosition(Vector2D(r.minValue.x + range.x * u, r.minValue.y + range.y * v));
+                    break;
+                case RandomField::Velocity:
+                    body.setVelocity(Vector2D(r.minValue.x + range.x * u, r.minValue.y + range.y * v));
+                    break;
+                case RandomField::Angle:
+                    body.setAngle(r.minValue.x + range.x * u);
+                    break;
+            }
+        }
+    }
+}
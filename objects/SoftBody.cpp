@@ -0,0 +1,419 @@
+#include "SoftBody.h"
+#include "ThreadPool.h"
+#include <OpenGL/gl.h>
+#include <algorithm>
+#include <cmath>
+
+SoftBodySystem::SoftBodySystem()
+    : substeps(8),
+      categoryBits(0x0001),
+      maskBits(0xFFFF)
+{}
+
+// ------------------ Building ------------------
+
+int SoftBodySystem::beginBody(const SoftBodyMaterial& material) {
+    SoftBodyRange body;
+    body.firstParticle = getParticleCount();
+    body.particleCount = 0;
+    body.radius = material.particleRadius;
+    body.friction = std::min(1.0f, std::max(0.0f, material.friction));
+    softBodies.push_back(body);
+    return getBodyCount() - 1;
+}
+
+int SoftBodySystem::addParticle(const Vector2D& pos, float mass) {
+    if (softBodies.empty()) beginBody(SoftBodyMaterial());
+
+    posX.push_back(pos.x);
+    posY.push_back(pos.y);
+    prevX.push_back(pos.x);
+    prevY.push_back(pos.y);
+    velX.push_back(0.0f);
+    velY.push_back(0.0f);
+    invMass.push_back(mass > 0.0f ? 1.0f / mass : 0.0f);
+    softBodies.back().particleCount++;
+    return getParticleCount() - 1;
+}
+
+void SoftBodySystem::addDistanceConstraint(int a, int b, float compliance) {
+    float dx = posX[b] - posX[a];
+    float dy = posY[b] - posY[a];
+    constraints.push_back({SoftConstraintType::Distance, {a, b, -1}, std::sqrt(dx * dx + dy * dy), compliance});
+    colorsDirty = true;
+}
+
+void SoftBodySystem::addAreaConstraint(int a, int b, int c, float compliance) {
+    // Signed area, positive for counter-clockwise triangles
+    float area = 0.5f * ((posX[b] - posX[a]) * (posY[c] - posY[a]) -
+                         (posY[b] - posY[a]) * (posX[c] - posX[a]));
+    constraints.push_back({SoftConstraintType::Area, {a, b, c}, area, compliance});
+    colorsDirty = true;
+}
+
+void SoftBodySystem::addBendingConstraint(int a, int b, float compliance) {
+    float dx = posX[b] - posX[a];
+    float dy = posY[b] - posY[a];
+    constraints.push_back({SoftConstraintType::Bending, {a, b, -1}, std::sqrt(dx * dx + dy * dy), compliance});
+    colorsDirty = true;
+}
+
+int SoftBodySystem::addBlock(const Vector2D& center, float width, float height, int columns, int rows,
+                             float totalMass, const SoftBodyMaterial& material) {
+    columns = std::max(2, columns);
+    rows = std::max(2, rows);
+    int body = beginBody(material);
+    int first = getParticleCount();
+    float mass = totalMass / (columns * rows);
+    float dx = width / (columns - 1);
+    float dy = height / (rows - 1);
+    Vector2D corner = center - Vector2D(width / 2, height / 2);
+
+    for (int j = 0; j < rows; j++)
+        for (int i = 0; i < columns; i++)
+            addParticle(corner + Vector2D(i * dx, j * dy), mass);
+
+    auto at = [&](int i, int j) { return first + j * columns + i; };
+    for (int j = 0; j < rows; j++) {
+        for (int i = 0; i < columns; i++) {
+            if (i + 1 < columns) addDistanceConstraint(at(i, j), at(i + 1, j), material.stretchCompliance);
+            if (j + 1 < rows) addDistanceConstraint(at(i, j), at(i, j + 1), material.stretchCompliance);
+            if (i + 2 < columns) addBendingConstraint(at(i, j), at(i + 2, j), material.bendingCompliance);
+            if (j + 2 < rows) addBendingConstraint(at(i, j), at(i, j + 2), material.bendingCompliance);
+
+            // Two counter-clockwise triangles per quad, split along the diagonal
+            if (i + 1 < columns && j + 1 < rows) {
+                addDistanceConstraint(at(i, j), at(i + 1, j + 1), material.stretchCompliance);
+                addAreaConstraint(at(i, j), at(i + 1, j), at(i + 1, j + 1), material.areaCompliance);
+                addAreaConstraint(at(i, j), at(i + 1, j + 1), at(i, j + 1), material.areaCompliance);
+            }
+        }
+    }
+    return body;
+}
+
+int SoftBodySystem::addCloth(const Vector2D& topLeft, int columns, int rows, float spacing,
+                             float totalMass, const SoftBodyMaterial& material, bool pinTop) {
+    columns = std::max(2, columns);
+    rows = std::max(2, rows);
+    int body = beginBody(material);
+    int first = getParticleCount();
+    float mass = totalMass / (columns * rows);
+
+    for (int j = 0; j < rows; j++)
+        for (int i = 0; i < columns; i++)
+            addParticle(topLeft + Vector2D(i * spacing, -j * spacing), (pinTop && j == 0) ? 0.0f : mass);
+
+    auto at = [&](int i, int j) { return first + j * columns + i; };
+    for (int j = 0; j < rows; j++) {
+        for (int i = 0; i < columns; i++) {
+            if (i + 1 < columns) addDistanceConstraint(at(i, j), at(i + 1, j), material.stretchCompliance);
+            if (j + 1 < rows) addDistanceConstraint(at(i, j), at(i, j + 1), material.stretchCompliance);
+            if (i + 2 < columns) addBendingConstraint(at(i, j), at(i + 2, j), material.bendingCompliance);
+            if (j + 2 < rows) addBendingConstraint(at(i, j), at(i, j + 2), material.bendingCompliance);
+        }
+    }
+    return body;
+}
+
+void SoftBodySystem::clear() {
+    posX.clear();
+    posY.clear();
+    prevX.clear();
+    prevY.clear();
+    velX.clear();
+    velY.clear();
+    invMass.clear();
+    softBodies.clear();
+    constraints.clear();
+    colorStart.clear();
+    colorsDirty = false;
+    lastColorSerial = false;
+}
+
+// ------------------ Graph coloring ------------------
+
+void SoftBodySystem::colorConstraints() {
+    // Greedy: each constraint takes the lowest color none of its particles uses yet.
+    // Meshes need far fewer than 64; anything left over goes to one serial color.
+    const int maxColors = 64;
+    std::vector<uint64_t> used(posX.size(), 0);
+    std::vector<int> color(constraints.size());
+    int colorCount = 0;
+
+    for (size_t k = 0; k < constraints.size(); k++) {
+        const SoftConstraint& c = constraints[k];
+        int arity = c.type == SoftConstraintType::Area ? 3 : 2;
+        uint64_t taken = 0;
+        for (int n = 0; n < arity; n++) taken |= used[c.p[n]];
+
+        int col = maxColors;
+        if (taken != ~0ULL) {
+            col = __builtin_ctzll(~taken);
+            for (int n = 0; n < arity; n++) used[c.p[n]] |= 1ULL << col;
+        }
+        color[k] = col;
+        colorCount = std::max(colorCount, col + 1);
+    }
+
+    // Stable counting sort by color so each color is one contiguous range
+    colorStart.assign(colorCount + 1, 0);
+    for (int col : color) colorStart[col + 1]++;
+    for (int col = 0; col < colorCount; col++) colorStart[col + 1] += colorStart[col];
+    std::vector<int> cursor(colorStart.begin(), colorStart.end() - 1);
+    std::vector<SoftConstraint> sorted(constraints.size());
+    for (size_t k = 0; k < constraints.size(); k++) sorted[cursor[color[k]]++] = constraints[k];
+    constraints.swap(sorted);
+
+    lastColorSerial = colorCount > maxColors;
+    colorsDirty = false;
+}
+
+// ------------------ Constraint projection ------------------
+
+void SoftBodySystem::solveConstraint(const SoftConstraint& c, float alpha) {
+    if (c.type == SoftConstraintType::Area) {
+        int a = c.p[0], b = c.p[1], d = c.p[2];
+        float area = 0.5f * ((posX[b] - posX[a]) * (posY[d] - posY[a]) -
+                             (posY[b] - posY[a]) * (posX[d] - posX[a]));
+
+        // Gradient of the signed area with respect to each corner
+        float gax = 0.5f * (posY[b] - posY[d]), gay = 0.5f * (posX[d] - posX[b]);
+        float gbx = 0.5f * (posY[d] - posY[a]), gby = 0.5f * (posX[a] - posX[d]);
+        float gdx = 0.5f * (posY[a] - posY[b]), gdy = 0.5f * (posX[b] - posX[a]);
+
+        float w = invMass[a] * (gax * gax + gay * gay) +
+                  invMass[b] * (gbx * gbx + gby * gby) +
+                  invMass[d] * (gdx * gdx + gdy * gdy);
+        if (w + alpha <= 0.0f) return;
+        float dl = -(area - c.rest) / (w + alpha);
+
+        posX[a] += invMass[a] * gax * dl;
+        posY[a] += invMass[a] * gay * dl;
+        posX[b] += invMass[b] * gbx * dl;
+        posY[b] += invMass[b] * gby * dl;
+        posX[d] += invMass[d] * gdx * dl;
+        posY[d] += invMass[d] * gdy * dl;
+        return;
+    }
+
+    // Distance and bending share the same projection, only the compliance differs
+    int a = c.p[0], b = c.p[1];
+    float w = invMass[a] + invMass[b];
+    if (w + alpha <= 0.0f) return;
+    float dx = posX[b] - posX[a];
+    float dy = posY[b] - posY[a];
+    float d = std::sqrt(dx * dx + dy * dy);
+    if (d < 1e-9f) return;
+
+    float dl = -(d - c.rest) / (w + alpha);
+    float nx = dx / d, ny = dy / d;
+    posX[a] -= invMass[a] * nx * dl;
+    posY[a] -= invMass[a] * ny * dl;
+    posX[b] += invMass[b] * nx * dl;
+    posY[b] += invMass[b] * ny * dl;
+}
+
+// ------------------ Collision ------------------
+
+void SoftBodySystem::updateBounds(SoftBodyRange& body) {
+    if (body.particleCount == 0) return;
+    int first = body.firstParticle;
+    int last = first + body.particleCount;
+    float minX = posX[first], maxX = posX[first], minY = posY[first], maxY = posY[first];
+    for (int i = first + 1; i < last; i++) {
+        minX = std::min(minX, posX[i]);
+        maxX = std::max(maxX, posX[i]);
+        minY = std::min(minY, posY[i]);
+        maxY = std::max(maxY, posY[i]);
+    }
+    body.bounds.min = Vector2D(minX - body.radius, minY - body.radius);
+    body.bounds.max = Vector2D(maxX + body.radius, maxY + body.radius);
+}
+
+void SoftBodySystem::applyFriction(int i, float nx, float ny, const Vector2D& surfaceVel, float friction, float h) {
+    // Remove part of the tangential motion this substep, relative to the surface
+    float mx = posX[i] - prevX[i] - surfaceVel.x * h;
+    float my = posY[i] - prevY[i] - surfaceVel.y * h;
+    float mn = mx * nx + my * ny;
+    posX[i] -= (mx - nx * mn) * friction;
+    posY[i] -= (my - ny * mn) * friction;
+}
+
+void SoftBodySystem::collideBodies(SoftBodyRange& body, const std::vector<RigidBody*>& bodies, float h) {
+    const int first = body.firstParticle;
+    const int last = first + body.particleCount;
+    const float r = body.radius;
+
+    for (RigidBody* rigid : bodies) {
+        Collider* collider = rigid->getCollider();
+        if (!collider || collider->isSensor()) continue;
+        if (collider->getType() == ColliderType::Plane) continue;  // Bounds are handled separately
+        if (!Collider::shouldCollide(categoryBits, maskBits, collider->getCategoryBits(), collider->getMaskBits())) continue;
+        if (!rigid->getAABB().overlaps(body.bounds)) continue;
+
+        Vector2D center = rigid->getPosition();
+        Vector2D surfaceVel = rigid->getVelocity();
+        bool isCircle = collider->getType() == ColliderType::Circle;
+        float bodyRadius = collider->getRadius();
+        float hw = collider->getWidth() / 2.0f;
+        float hh = collider->getHeight() / 2.0f;
+        float c = rigid->getCosAngle();
+        float s = rigid->getSinAngle();
+
+        for (int i = first; i < last; i++) {
+            if (invMass[i] == 0.0f) continue;
+            float dx = posX[i] - center.x;
+            float dy = posY[i] - center.y;
+            float nx, ny, depth;
+
+            if (isCircle) {
+                float d2 = dx * dx + dy * dy;
+                float reach = bodyRadius + r;
+                if (d2 >= reach * reach || d2 < 1e-12f) continue;
+                float d = std::sqrt(d2);
+                nx = dx / d;
+                ny = dy / d;
+                depth = reach - d;
+            } else {
+                // Closest point on the rectangle in its local frame
+                float lx = dx * c + dy * s;
+                float ly = -dx * s + dy * c;
+                float qx = std::max(-hw, std::min(hw, lx));
+                float qy = std::max(-hh, std::min(hh, ly));
+                float ex = lx - qx, ey = ly - qy;
+                float d2 = ex * ex + ey * ey;
+                float lnx, lny;
+                if (d2 > 1e-12f) {
+                    if (d2 >= r * r) continue;
+                    float d = std::sqrt(d2);
+                    lnx = ex / d;
+                    lny = ey / d;
+                    depth = r - d;
+                } else {
+                    // Inside: push out through the nearest face
+                    float px = hw - std::abs(lx), py = hh - std::abs(ly);
+                    if (px < py) { lnx = lx >= 0 ? 1.0f : -1.0f; lny = 0.0f; depth = px + r; }
+                    else { lnx = 0.0f; lny = ly >= 0 ? 1.0f : -1.0f; depth = py + r; }
+                }
+                nx = lnx * c - lny * s;
+                ny = lnx * s + lny * c;
+            }
+
+            posX[i] += nx * depth;
+            posY[i] += ny * depth;
+            applyFriction(i, nx, ny, surfaceVel, body.friction, h);
+        }
+    }
+}
+
+void SoftBodySystem::collideBounds(SoftBodyRange& body, const Physics& physics, float h) {
+    const int first = body.firstParticle;
+    const int last = first + body.particleCount;
+    const float r = body.radius;
+    const float halfW = physics.getWorldWidth() / 2;
+    const float halfH = physics.getWorldHeight() / 2;
+    const bool left = physics.getBoundary(BoundarySide::Left) == BoundaryMode::Solid;
+    const bool right = physics.getBoundary(BoundarySide::Right) == BoundaryMode::Solid;
+    const bool bottom = physics.getBoundary(BoundarySide::Bottom) == BoundaryMode::Solid;
+    const bool top = physics.getBoundary(BoundarySide::Top) == BoundaryMode::Solid;
+
+    // Only bodies touching a wall need the per-particle pass
+    if (!(left && body.bounds.min.x < -halfW) && !(right && body.bounds.max.x > halfW) &&
+        !(bottom && body.bounds.min.y < -halfH) && !(top && body.bounds.max.y > halfH)) return;
+
+    for (int i = first; i < last; i++) {
+        if (invMass[i] == 0.0f) continue;
+        if (left && posX[i] < -halfW + r) {
+            posX[i] = -halfW + r;
+            applyFriction(i, 1.0f, 0.0f, Vector2D(), body.friction, h);
+        }
+        if (right && posX[i] > halfW - r) {
+            posX[i] = halfW - r;
+            applyFriction(i, -1.0f, 0.0f, Vector2D(), body.friction, h);
+        }
+        if (bottom && posY[i] < -halfH + r) {
+            posY[i] = -halfH + r;
+            applyFriction(i, 0.0f, 1.0f, Vector2D(), body.friction, h);
+        }
+        if (top && posY[i] > halfH - r) {
+            posY[i] = halfH - r;
+            applyFriction(i, 0.0f, -1.0f, Vector2D(), body.friction, h);
+        }
+    }
+}
+
+// ------------------ Step ------------------
+
+void SoftBodySystem::step(float dt, const Physics& physics, const std::vector<RigidBody*>& bodies) {
+    if (posX.empty()) return;
+    if (colorsDirty) colorConstraints();
+
+    const int n = getParticleCount();
+    const float h = dt / substeps;
+    const Vector2D gravity = physics.getGravity();
+    ThreadPool& pool = ThreadPool::shared();
+
+    for (int sub = 0; sub < substeps; sub++) {
+        // Predict
+        for (int i = 0; i < n; i++) {
+            prevX[i] = posX[i];
+            prevY[i] = posY[i];
+            float moving = invMass[i] > 0.0f ? 1.0f : 0.0f;
+            velX[i] += gravity.x * h * moving;
+            velY[i] += gravity.y * h * moving;
+            posX[i] += velX[i] * h;
+            posY[i] += velY[i] * h;
+        }
+
+        // One pass over the constraints, color by color
+        const int colors = getColorCount();
+        for (int col = 0; col < colors; col++) {
+            int begin = colorStart[col];
+            int count = colorStart[col + 1] - begin;
+            if (lastColorSerial && col == colors - 1) {
+                for (int k = begin; k < begin + count; k++) {
+                    solveConstraint(constraints[k], constraints[k].compliance / (h * h));
+                }
+                continue;
+            }
+            pool.parallelFor(count, 256, [&](int from, int to) {
+                for (int k = begin + from; k < begin + to; k++) {
+                    solveConstraint(constraints[k], constraints[k].compliance / (h * h));
+                }
+            });
+        }
+
+        // Meshes own disjoint particle runs, so they can collide in parallel
+        pool.parallelFor(getBodyCount(), 4, [&](int from, int to) {
+            for (int b = from; b < to; b++) {
+                updateBounds(softBodies[b]);
+                collideBodies(softBodies[b], bodies, h);
+                collideBounds(softBodies[b], physics, h);
+            }
+        });
+
+        // Velocities from the corrected positions
+        const float invH = 1.0f / h;
+        for (int i = 0; i < n; i++) {
+            velX[i] = (posX[i] - prevX[i]) * invH;
+            velY[i] = (posY[i] - prevY[i]) * invH;
+        }
+    }
+}
+
+// ------------------ Rendering ------------------
+
+void SoftBodySystem::draw() const {
+    float scale = RigidBody::pixelsPerMeter;
+
+    // Edges only; bending constraints would just clutter the mesh
+    glColor3f(0.2f, 0.7f, 1.0f);
+    glBegin(GL_LINES);
+    for (const SoftConstraint& c : constraints) {
+        if (c.type != SoftConstraintType::Distance) continue;
+        glVertex2f(posX[c.p[0]] * scale, posY[c.p[0]] * scale);
+        glVertex2f(posX[c.p[1]] * scale, posY[c.p[1]] * scale);
+    }
+    glEnd();
+}
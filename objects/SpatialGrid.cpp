@@ -0,0 +1,167 @@
+#include "SpatialGrid.h"
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : cellSize(cellSize), activeCellSize(1.0f), invCellSize(1.0f) {}
+
+void SpatialGrid::setPeriodic(bool wrapX, bool wrapY, const AABB& domain) {
+    periodicX = wrapX;
+    periodicY = wrapY;
+    periodicDomain = domain;
+}
+
+void SpatialGrid::addGhosts() {
+    // Widest body decides how close to the low edge a body must be to need a ghost
+    float reach = 0.0f;
+    for (const Proxy& p : proxies) {
+        Vector2D extent = p.bounds.max - p.bounds.min;
+        if (std::isfinite(extent.x) && std::isfinite(extent.y)) {
+            reach = std::max(reach, std::max(extent.x, extent.y));
+        }
+    }
+
+    Vector2D period = periodicDomain.max - periodicDomain.min;
+    size_t realCount = proxies.size();
+    for (size_t i = 0; i < realCount; i++) {
+        Proxy p = proxies[i];
+        if (!std::isfinite(p.bounds.min.x) || !std::isfinite(p.bounds.max.x) ||
+            !std::isfinite(p.bounds.min.y) || !std::isfinite(p.bounds.max.y)) continue;
+
+        bool nearX = periodicX && p.bounds.min.x < periodicDomain.min.x + reach;
+        bool nearY = periodicY && p.bounds.min.y < periodicDomain.min.y + reach;
+        for (int shift = 1; shift < 4; shift++) {
+            bool shiftX = (shift & 1) != 0;
+            bool shiftY = (shift & 2) != 0;
+            if ((shiftX && !nearX) || (shiftY && !nearY)) continue;
+
+            Vector2D offset(shiftX ? period.x : 0.0f, shiftY ? period.y : 0.0f);
+            Proxy ghost = p;
+            ghost.bounds = AABB{p.bounds.min + offset, p.bounds.max + offset};
+            ghost.offset = offset;
+            ghost.ghost = true;
+            ghost.source = static_cast<int>(i);
+            proxies.push_back(ghost);
+        }
+    }
+}
+
+float SpatialGrid::autoCellSize(std::vector<float>& sizes) {
+    // Twice the median body extent keeps typical bodies in 1-4 cells
+    sizes.erase(std::remove_if(sizes.begin(), sizes.end(), [](float size) { return !std::isfinite(size); }),
+                sizes.end());  // Boundary planes
+    if (sizes.empty()) return 0.0f;
+    auto mid = sizes.begin() + sizes.size() / 2;
+    std::nth_element(sizes.begin(), mid, sizes.end());
+    return std::max(2.0f * *mid, 1e-3f);
+}
+
+void SpatialGrid::chooseCellSize(float autoSize) {
+    if (cellSize > 0.0f) {
+        activeCellSize = cellSize;
+    } else if (autoSize > 0.0f) {
+        activeCellSize = autoSize;
+    } else if (!proxies.empty()) {
+        sizeScratch.clear();
+        for (const Proxy& p : proxies) {
+            Vector2D extent = p.bounds.max - p.bounds.min;
+            sizeScratch.push_back(std::max(extent.x, extent.y));
+        }
+        float size = autoCellSize(sizeScratch);
+        if (size > 0.0f) activeCellSize = size;
+    }
+    invCellSize = 1.0f / activeCellSize;
+}
+
+void SpatialGrid::build(const std::vector<RigidBody*>& bodies, float autoSize) {
+    proxies.clear();
+    largeProxies.clear();
+
+    for (RigidBody* body : bodies) {
+        if (!body->getCollider()) continue;
+        Proxy p;
+        p.bounds = body->getAABB();
+        p.body = body;
+        p.categoryBits = body->getCollider()->getCategoryBits();
+        p.maskBits = body->getCollider()->getMaskBits();
+        p.ghost = false;
+        p.source = static_cast<int>(proxies.size());
+        p.offset = Vector2D();
+        proxies.push_back(p);
+    }
+    chooseCellSize(autoSize);
+    if (periodicX || periodicY) {
+        addGhosts();
+    }
+
+    // Assign cell ranges and count how many cell entries we need
+    const float inf = std::numeric_limits<float>::infinity();
+    gridBounds = AABB{Vector2D(inf, inf), Vector2D(-inf, -inf)};
+    allBounds = gridBounds;
+    size_t entryCount = 0;
+    for (int i = 0; i < static_cast<int>(proxies.size()); i++) {
+        Proxy& p = proxies[i];
+        // Boundary planes are unbounded and would make every ray endless
+        if (std::isfinite(p.bounds.min.x) && std::isfinite(p.bounds.max.x) &&
+            std::isfinite(p.bounds.min.y) && std::isfinite(p.bounds.max.y)) {
+            allBounds.min.x = std::min(allBounds.min.x, p.bounds.min.x);
+            allBounds.min.y = std::min(allBounds.min.y, p.bounds.min.y);
+            allBounds.max.x = std::max(allBounds.max.x, p.bounds.max.x);
+            allBounds.max.y = std::max(allBounds.max.y, p.bounds.max.y);
+        }
+        p.x0 = cellCoord(p.bounds.min.x);
+        p.y0 = cellCoord(p.bounds.min.y);
+        p.x1 = cellCoord(p.bounds.max.x);
+        p.y1 = cellCoord(p.bounds.max.y);
+        int64_t cells = (int64_t(p.x1) - p.x0 + 1) * (int64_t(p.y1) - p.y0 + 1);
+        p.large = cells > maxCellsPerProxy;
+        if (p.large) {
+            largeProxies.push_back(i);
+            continue;
+        }
+        entryCount += static_cast<size_t>(cells);
+        gridBounds.min.x = std::min(gridBounds.min.x, p.bounds.min.x);
+        gridBounds.min.y = std::min(gridBounds.min.y, p.bounds.min.y);
+        gridBounds.max.x = std::max(gridBounds.max.x, p.bounds.max.x);
+        gridBounds.max.y = std::max(gridBounds.max.y, p.bounds.max.y);
+    }
+
+    // Power-of-two bucket table with room to spare
+    size_t buckets = 64;
+    while (buckets < entryCount * 2) buckets <<= 1;
+    bucketMask = static_cast<unsigned>(buckets - 1);
+
+    // Counting sort: histogram, prefix sum, scatter.
+    // A proxy is stored at most once per bucket even if two of its cells hash together.
+    cellStart.assign(buckets + 1, 0);
+    bucketStamp.assign(buckets, -1);
+    for (int i = 0; i < static_cast<int>(proxies.size()); i++) {
+        const Proxy& p = proxies[i];
+        if (p.large) continue;
+        for (int cy = p.y0; cy <= p.y1; cy++) {
+            for (int cx = p.x0; cx <= p.x1; cx++) {
+                unsigned bucket = bucketOf(cx, cy);
+                if (bucketStamp[bucket] == i) continue;
+                bucketStamp[bucket] = i;
+                cellStart[bucket + 1]++;
+            }
+        }
+    }
+    for (size_t b = 0; b < buckets; b++) {
+        cellStart[b + 1] += cellStart[b];
+    }
+
+    cellEntries.resize(cellStart[buckets]);
+    bucketCursor.assign(cellStart.begin(), cellStart.end() - 1);
+    std::fill(bucketStamp.begin(), bucketStamp.end(), -1);
+    for (int i = 0; i < static_cast<int>(proxies.size()); i++) {
+        const Proxy& p = proxies[i];
+        if (p.large) continue;
+        for (int cy = p.y0; cy <= p.y1; cy++) {
+            for (int cx = p.x0; cx <= p.x1; cx++) {
+                unsigned bucket = bucketOf(cx, cy);
+                if (bucketStamp[bucket] == i) continue;
+                bucketStamp[bucket] = i;
+                cellEntries[bucketCursor[bucket]++] = i;
+            }
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#include "StateExport.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint32_t SHARED_STATE_VERSION = 1;
+static const uint32_t ARRAY_COUNT = static_cast<uint32_t>(SharedStateArray::Count);
+
+static size_t slotBytesFor(uint32_t capacity) {
+    return sizeof(SharedStateSlot) + static_cast<size_t>(ARRAY_COUNT) * capacity * 4;
+}
+
+// ------------------ Writer ------------------
+
+StateExporter::~StateExporter() {
+    close();
+}
+
+SharedStateSlot* StateExporter::slot(int index) const {
+    return reinterpret_cast<SharedStateSlot*>(base + sizeof(SharedStateHeader) + index * header()->slotBytes);
+}
+
+bool StateExporter::open(const char* shmName, int capacity) {
+    close();
+    if (capacity <= 0 || std::strlen(shmName) >= sizeof(name)) return false;
+
+    // Round up so every array starts on a 64-byte boundary
+    uint32_t cap = (static_cast<uint32_t>(capacity) + 15u) & ~15u;
+    size_t bytes = sizeof(SharedStateHeader) + 2 * slotBytesFor(cap);
+
+    fd = shm_open(shmName, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::perror("shm_open");
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        std::perror("ftruncate");
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::perror("mmap");
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    base = static_cast<uint8_t*>(mapped);
+    mappedBytes = bytes;
+    std::strcpy(name, shmName);
+    time = 0.0;
+
+    // The object may be left over from an earlier run with another size.
+    // Readers check the magic last, so write it after everything else.
+    std::memset(base, 0, bytes);
+    SharedStateHeader* h = header();
+    h->version = SHARED_STATE_VERSION;
+    h->capacity = cap;
+    h->arrayCount = ARRAY_COUNT;
+    h->slotBytes = slotBytesFor(cap);
+    h->epoch.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(h->magic, "PHSX", 4);
+    return true;
+}
+
+void StateExporter::close() {
+    if (base) {
+        munmap(base, mappedBytes);
+        shm_unlink(name);
+    }
+    if (fd >= 0) ::close(fd);
+    base = nullptr;
+    fd = -1;
+    mappedBytes = 0;
+}
+
+void StateExporter::publish(const std::vector<RigidBody*>& bodies, uint64_t frame, float dt) {
+    if (!base) return;
+    time += dt;
+
+    // Write into the slot the newest frame is not in
+    SharedStateHeader* h = header();
+    uint64_t epoch = h->epoch.load(std::memory_order_relaxed);
+    SharedStateSlot* s = slot(static_cast<int>((epoch + 1) & 1));
+
+    uint64_t sequence = s->sequence.load(std::memory_order_relaxed);
+    s->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t cap = h->capacity;
+    uint32_t count = bodies.size() < cap ? static_cast<uint32_t>(bodies.size()) : cap;
+    uint8_t* data = reinterpret_cast<uint8_t*>(s) + sizeof(SharedStateSlot);
+    uint32_t* ids = reinterpret_cast<uint32_t*>(data);
+    uint32_t* flags = ids + cap;
+    float* posX = reinterpret_cast<float*>(flags + cap);
+    float* posY = posX + cap;
+    float* velX = posY + cap;
+    float* velY = velX + cap;
+    float* angle = velY + cap;
+    float* angularV = angle + cap;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const RigidBody* body = bodies[i];
+        BodyState state = body->getState();
+        ids[i] = body->getId();
+        flags[i] = body->isStaticBody() ? 1u : 0u;
+        posX[i] = state.position.x;
+        posY[i] = state.position.y;
+        velX[i] = state.velocity.x;
+        velY[i] = state.velocity.y;
+        angle[i] = state.angle;
+        angularV[i] = state.angularV;
+    }
+    s->frame = frame;
+    s->time = time;
+    s->count = count;
+    s->dropped = static_cast<uint32_t>(bodies.size() - count);
+
+    // Close the slot, then make it the newest
+    s->sequence.store(sequence + 2, std::memory_order_release);
+    h->epoch.store(epoch + 1, std::memory_order_release);
+}
+
+// ------------------ Reader ------------------
+
+StateReader::~StateReader() {
+    close();
+}
+
+bool StateReader::open(const char* shmName) {
+    close();
+    fd = shm_open(shmName, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedStateHeader)) {
+        close();
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    base = static_cast<const uint8_t*>(mapped);
+    mappedBytes = static_cast<size_t>(info.st_size);
+
+    // Reject anything that isn't a finished version 1 region of the size it claims
+    const SharedStateHeader* h = header();
+    bool valid = std::memcmp(h->magic, "PHSX", 4) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    valid = valid && h->version == SHARED_STATE_VERSION && h->arrayCount == ARRAY_COUNT &&
+            h->slotBytes == slotBytesFor(h->capacity) &&
+            mappedBytes >= sizeof(SharedStateHeader) + 2 * h->slotBytes;
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void StateReader::close() {
+    if (base) munmap(const_cast<uint8_t*>(base), mappedBytes);
+    if (fd >= 0) ::close(fd);
+    base = nullptr;
+    fd = -1;
+    mappedBytes = 0;
+}
+
+const SharedStateSlot* StateReader::beginRead(uint64_t& sequence) const {
+    const SharedStateHeader* h = header();
+    uint64_t epoch = h->epoch.load(std::memory_order_acquire);
+    if (epoch == 0) return nullptr;
+
+    const SharedStateSlot* s = reinterpret_cast<const SharedStateSlot*>(
+        base + sizeof(SharedStateHeader) + (epoch & 1) * h->slotBytes);
+    sequence = s->sequence.load(std::memory_order_acquire);
+    if (sequence & 1) return nullptr;
+    return s;
+}
+
+bool StateReader::endRead(const SharedStateSlot* slot, uint64_t sequence) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == sequence;
+}